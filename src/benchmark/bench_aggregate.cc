@@ -0,0 +1,69 @@
+// Rolling sums of mapped values over key ranges: visiting every entry of
+// the range versus combining the subtree sums kept by SumAugment.
+//
+//   make bench
+//   ./benchmark/bench_aggregate 1000000 5000
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using SumMap = s21::S21Map<uint64_t, uint64_t, std::less<uint64_t>,
+                           s21::SumAugment<uint64_t, s21::ProjectMapped>>;
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  uint64_t width = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000;
+  constexpr size_t queries = 20000;
+
+  SumMap map;
+  auto start = Clock::now();
+  for (uint64_t key = 0; key < count; key++) {
+    map.emplace_hint(map.end(), key, key % 97);
+  }
+  double build =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+      count;
+
+  std::mt19937_64 random(42);
+  uint64_t visited_total = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < queries; i++) {
+    uint64_t low = random() % count;
+    map.for_each_in_range(low, low + width, [&visited_total](const auto &e) {
+      visited_total += e.second;
+    });
+  }
+  double visit =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      queries;
+
+  random.seed(42);
+  uint64_t aggregated_total = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < queries; i++) {
+    uint64_t low = random() % count;
+    aggregated_total += map.aggregate(low, low + width);
+  }
+  double aggregate =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      queries;
+
+  std::printf("%zu keys, ranges of %llu keys, %.1f ns/insert\n", count,
+              static_cast<unsigned long long>(width), build);
+  std::printf("for_each_in_range %9.2f us/query\n", visit);
+  std::printf("aggregate         %9.2f us/query  (x%.0f)\n", aggregate,
+              visit / aggregate);
+  return visited_total == aggregated_total ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Lookup and scan throughput of the AVL node tree (S21Set) against the
+// B-tree engine (S21BTreeSet) on random 8-byte keys.
+//
+//   make bench                       # 1M keys
+//   ./benchmark/bench_btree 30000000 # 30M keys
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename Set>
+void Run(const char *name, const std::vector<uint64_t> &keys,
+         const std::vector<uint64_t> &probes) {
+  Set set;
+  auto start = Clock::now();
+  for (uint64_t key : keys) {
+    set.insert(key);
+  }
+  double insert_time = SecondsSince(start);
+
+  start = Clock::now();
+  size_t found = 0;
+  for (uint64_t probe : probes) {
+    found += set.contains(probe) ? 1 : 0;
+  }
+  double lookup_time = SecondsSince(start);
+
+  start = Clock::now();
+  uint64_t checksum = 0;
+  for (auto it = set.begin(); it != set.end(); ++it) {
+    checksum += *it;
+  }
+  double scan_time = SecondsSince(start);
+
+  std::printf("%-12s insert %7.1f ns/op  lookup %7.1f ns/op  "
+              "scan %6.2f ns/elem  (found %zu, checksum %llu)\n",
+              name, insert_time * 1e9 / keys.size(),
+              lookup_time * 1e9 / probes.size(),
+              scan_time * 1e9 / set.size(), found,
+              static_cast<unsigned long long>(checksum));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::mt19937_64 generator(42);
+  std::vector<uint64_t> keys(count);
+  for (uint64_t &key : keys) {
+    key = generator();
+  }
+  std::vector<uint64_t> probes(count);
+  for (size_t i = 0; i < count; i++) {
+    probes[i] = keys[generator() % count];
+  }
+  std::printf("%zu random 64-bit keys\n", count);
+  Run<s21::S21Set<uint64_t>>("S21Set", keys, probes);
+  Run<s21::S21BTreeSet<uint64_t>>("S21BTreeSet", keys, probes);
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Memory and speed of a large integer set: the pointer-based S21Set versus
+// S21CompactSet, whose nodes are linked by 32-bit indexes.
+//
+//   make bench
+//   ./benchmark/bench_compact 10000000
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double NanosPerOp(Clock::time_point start, size_t ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         ops;
+}
+
+template <typename Set>
+size_t InsertAll(Set &set, const std::vector<int> &values, double &insert) {
+  auto start = Clock::now();
+  for (int value : values) {
+    set.insert(value);
+  }
+  insert = NanosPerOp(start, values.size());
+  return set.size();
+}
+
+template <typename Set>
+size_t FindAll(const Set &set, const std::vector<int> &probes, double &find) {
+  size_t hits = 0;
+  auto start = Clock::now();
+  for (int probe : probes) {
+    hits += set.contains(probe);
+  }
+  find = NanosPerOp(start, probes.size());
+  return hits;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::mt19937 random(42);
+  std::vector<int> values(count);
+  for (int &value : values) {
+    value = static_cast<int>(random() & 0x7fffffff);
+  }
+  std::vector<int> probes(1000000);
+  for (int &probe : probes) {
+    probe = values[random() % count];
+  }
+
+  double insert = 0;
+  double find = 0;
+  size_t pointer_hits = 0;
+  {
+    s21::S21Set<int> set;
+    size_t size = InsertAll(set, values, insert);
+    pointer_hits = FindAll(set, probes, find);
+    double bytes = static_cast<double>(set.arena()->capacity() *
+                                       sizeof(s21::S21Set<int>::node));
+    std::printf("S21Set         %6.1f bytes/element %8.1f ns/insert %8.1f "
+                "ns/find\n",
+                bytes / size, insert, find);
+  }
+  size_t compact_hits = 0;
+  {
+    s21::S21CompactSet<int> set;
+    size_t size = InsertAll(set, values, insert);
+    compact_hits = FindAll(set, probes, find);
+    set.shrink_to_fit();
+    std::printf("S21CompactSet  %6.1f bytes/element %8.1f ns/insert %8.1f "
+                "ns/find\n",
+                static_cast<double>(set.memory_usage()) / size, insert, find);
+  }
+  return pointer_hits == compact_hits ? 0 : 1;
+}
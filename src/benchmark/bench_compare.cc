@@ -0,0 +1,126 @@
+// Key comparisons and time per operation for the insertion paths of
+// S21Map, next to std::map. A descent through an AVL tree of n keys makes
+// about log2(n) + 1 comparisons; every path should cost one descent.
+//
+//   make bench
+//   ./benchmark/bench_compare 1000000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t comparisons = 0;
+
+struct CountingLess {
+  bool operator()(uint64_t a, uint64_t b) const {
+    comparisons++;
+    return a < b;
+  }
+};
+
+using Map = s21::S21Map<uint64_t, uint64_t, CountingLess>;
+using Reference = std::map<uint64_t, uint64_t, CountingLess>;
+
+struct Cost {
+  double comparisons;
+  double nanoseconds;
+};
+
+template <typename Container, typename Operation>
+Cost Measure(Container &container, const std::vector<uint64_t> &keys,
+             Operation operation) {
+  comparisons = 0;
+  auto start = Clock::now();
+  for (uint64_t key : keys) {
+    operation(container, key);
+  }
+  double elapsed =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return Cost{static_cast<double>(comparisons) / keys.size(),
+              elapsed / keys.size()};
+}
+
+void Report(const char *operation, Cost s21, Cost reference) {
+  std::printf("%-26s S21Map %5.1f cmp %7.1f ns  std::map %5.1f cmp %7.1f ns\n",
+              operation, s21.comparisons, s21.nanoseconds,
+              reference.comparisons, reference.nanoseconds);
+}
+
+template <typename Container>
+void Fill(Container &container, const std::vector<uint64_t> &keys) {
+  for (uint64_t key : keys) {
+    container.insert({key, key});
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::vector<uint64_t> present(count);
+  std::vector<uint64_t> absent(count);
+  for (size_t i = 0; i < count; i++) {
+    present[i] = 2 * i;
+    absent[i] = 2 * i + 1;
+  }
+  std::mt19937_64 random(42);
+  std::shuffle(present.begin(), present.end(), random);
+  std::shuffle(absent.begin(), absent.end(), random);
+
+  Map map;
+  Reference reference;
+  Report("insert(k, v), new key",
+         Measure(map, present,
+                 [](Map &m, uint64_t key) { m.insert(key, key); }),
+         Measure(reference, present, [](Reference &m, uint64_t key) {
+           m.insert({key, key});
+         }));
+  Report("insert(k, v), present",
+         Measure(map, present,
+                 [](Map &m, uint64_t key) { m.insert(key, key); }),
+         Measure(reference, present, [](Reference &m, uint64_t key) {
+           m.insert({key, key});
+         }));
+  Report("insert(pair), present",
+         Measure(map, present,
+                 [](Map &m, uint64_t key) { m.insert({key, key}); }),
+         Measure(reference, present, [](Reference &m, uint64_t key) {
+           m.insert({key, key});
+         }));
+  Report("insert_or_assign, present",
+         Measure(map, present,
+                 [](Map &m, uint64_t key) { m.insert_or_assign(key, 1); }),
+         Measure(reference, present, [](Reference &m, uint64_t key) {
+           m.insert_or_assign(key, 1);
+         }));
+  Report("operator[], present",
+         Measure(map, present, [](Map &m, uint64_t key) { m[key]++; }),
+         Measure(reference, present,
+                 [](Reference &m, uint64_t key) { m[key]++; }));
+  Report("operator[], new key",
+         Measure(map, absent, [](Map &m, uint64_t key) { m[key]++; }),
+         Measure(reference, absent,
+                 [](Reference &m, uint64_t key) { m[key]++; }));
+  Map other;
+  Reference other_reference;
+  Fill(other, present);
+  Fill(other_reference, present);
+  Report("insert_or_assign, new key",
+         Measure(other, absent,
+                 [](Map &m, uint64_t key) { m.insert_or_assign(key, 1); }),
+         Measure(other_reference, absent, [](Reference &m, uint64_t key) {
+           m.insert_or_assign(key, 1);
+         }));
+  return 0;
+}
@@ -0,0 +1,110 @@
+// Throughput of a mutex-guarded S21Map against ConcurrentMap for 1 to 32
+// threads at several read/write ratios. Each thread runs a fixed number of
+// operations on random keys; the table shows millions of operations per
+// second over all threads.
+//
+//   make bench                                # 100k keys, 200k ops/thread
+//   ./benchmark/bench_concurrent 1000000 1000000
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class LockedMap {
+ public:
+  bool find(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_.contains(key);
+  }
+  void write(uint64_t key, uint64_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.insert_or_assign(key, value);
+  }
+
+ private:
+  std::mutex mutex_;
+  s21::S21Map<uint64_t, uint64_t> map_;
+};
+
+class LockFreeReadMap {
+ public:
+  bool find(uint64_t key) { return map_.contains(key); }
+  void write(uint64_t key, uint64_t value) {
+    map_.insert_or_assign(key, value);
+  }
+
+ private:
+  s21::ConcurrentMap<uint64_t, uint64_t> map_;
+};
+
+template <typename Map>
+double Run(Map &map, size_t keys, size_t ops, int threads, int read_percent) {
+  std::vector<std::thread> workers;
+  auto start = Clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&map, keys, ops, read_percent, t] {
+      std::mt19937_64 generator(t);
+      size_t found = 0;
+      for (size_t i = 0; i < ops; i++) {
+        uint64_t key = generator() % keys;
+        if (static_cast<int>(generator() % 100) < read_percent) {
+          found += map.find(key) ? 1 : 0;
+        } else {
+          map.write(key, i);
+        }
+      }
+      if (found == ops + 1) {
+        std::printf("unreachable\n");
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return threads * ops / seconds / 1e6;
+}
+
+template <typename Map>
+void Fill(Map &map, size_t keys) {
+  for (size_t key = 0; key < keys; key += 2) {
+    map.write(key, key);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+  std::printf("%zu keys, %zu ops per thread, %u hardware threads\n", keys,
+              ops, std::thread::hardware_concurrency());
+  std::printf("%-8s %-7s %12s %16s\n", "reads", "threads", "mutex Mops/s",
+              "lock-free Mops/s");
+  for (int read_percent : {90, 98, 100}) {
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+      LockedMap locked;
+      LockFreeReadMap lock_free;
+      Fill(locked, keys);
+      Fill(lock_free, keys);
+      double locked_rate = Run(locked, keys, ops, threads, read_percent);
+      double lock_free_rate =
+          Run(lock_free, keys, ops, threads, read_percent);
+      std::printf("%3d%%     %-7d %12.2f %16.2f\n", read_percent, threads,
+                  locked_rate, lock_free_rate);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+// Time and heap allocations of a deep copy of S21Set, on one thread and
+// on every hardware thread, against std::set.
+//
+//   make bench                       # 1M keys
+//   ./benchmark/bench_copy 10000000  # 10M keys
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <thread>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+}  // namespace
+
+void *operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Copy>
+void Measure(const char *name, size_t count, Copy copy) {
+  size_t before = allocations.load();
+  auto start = Clock::now();
+  size_t copied = copy();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  std::printf("%-22s %7.1f ns/elem  %8zu allocations  (%zu copied)\n", name,
+              seconds * 1e9 / count, allocations.load() - before, copied);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::mt19937_64 generator(42);
+  s21::S21Set<uint64_t> set;
+  std::set<uint64_t> reference;
+  while (set.size() < count) {
+    uint64_t key = generator();
+    set.insert(key);
+    reference.insert(key);
+  }
+  std::printf("%zu random 64-bit keys, %u hardware threads\n", count,
+              std::thread::hardware_concurrency());
+  Measure("std::set copy", count, [&] {
+    std::set<uint64_t> copy(reference);
+    return copy.size();
+  });
+  Measure("S21Set copy, 1 thread", count, [&] {
+    s21::S21Set<uint64_t> copy;
+    copy.assign(set, 1);
+    return copy.size();
+  });
+  Measure("S21Set copy, parallel", count, [&] {
+    s21::S21Set<uint64_t> copy(set);
+    return copy.size();
+  });
+  return 0;
+}
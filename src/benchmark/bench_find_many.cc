@@ -0,0 +1,81 @@
+// Batched point lookups against a map much larger than the caches: a loop
+// of find calls versus find_many, which interleaves the descents of a
+// batch and prefetches each next node, for batch sizes 1 to 512.
+//
+//   make bench
+//   ./benchmark/bench_find_many 2000000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Map = s21::S21Map<uint64_t, uint64_t>;
+
+double NanosPerKey(Clock::time_point start, size_t keys) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         keys;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+  constexpr size_t lookups = 1 << 20;
+
+  // Inserting in random order scatters neighbouring nodes over the arena.
+  std::vector<uint64_t> keys(count);
+  for (size_t i = 0; i < count; i++) {
+    keys[i] = i * 2;
+  }
+  std::mt19937_64 random(42);
+  std::shuffle(keys.begin(), keys.end(), random);
+  Map map;
+  for (uint64_t key : keys) {
+    map.insert(key, key / 2);
+  }
+
+  std::vector<uint64_t> probes(lookups);
+  for (uint64_t &probe : probes) {
+    probe = random() % (count * 2);
+  }
+  std::vector<decltype(map.begin())> found(512, map.end());
+
+  std::printf("%zu keys, %zu lookups, half of them hits\n", count, lookups);
+  std::printf("%6s %12s %14s %8s\n", "batch", "find ns/key", "find_many ns",
+              "speedup");
+  uint64_t looped_total = 0;
+  uint64_t batched_total = 0;
+  for (size_t batch = 1; batch <= 512; batch *= 2) {
+    auto start = Clock::now();
+    for (size_t i = 0; i + batch <= lookups; i += batch) {
+      for (size_t j = 0; j < batch; j++) {
+        auto it = map.find(probes[i + j]);
+        looped_total += it != map.end() ? (*it).second : 1;
+      }
+    }
+    double looped = NanosPerKey(start, lookups);
+
+    start = Clock::now();
+    for (size_t i = 0; i + batch <= lookups; i += batch) {
+      map.find_many(probes.begin() + i, probes.begin() + i + batch,
+                    found.begin());
+      for (size_t j = 0; j < batch; j++) {
+        batched_total += found[j] != map.end() ? (*found[j]).second : 1;
+      }
+    }
+    double batched = NanosPerKey(start, lookups);
+    std::printf("%6zu %12.1f %14.1f %7.2fx\n", batch, looped, batched,
+                looped / batched);
+  }
+  return looped_total == batched_total ? 0 : 1;
+}
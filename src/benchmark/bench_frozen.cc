@@ -0,0 +1,71 @@
+// Lookup throughput of a frozen index against the live trees it is built
+// from, on random 32-bit and 64-bit keys with half of the probes missing.
+//
+//   make bench                        # 1M keys
+//   ./benchmark/bench_frozen 10000000 # 10M keys
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename Set, typename Key>
+void Lookup(const char *name, const Set &set, const std::vector<Key> &probes) {
+  auto start = Clock::now();
+  size_t found = 0;
+  for (const Key &probe : probes) {
+    found += set.contains(probe) ? 1 : 0;
+  }
+  double lookup_time = SecondsSince(start);
+  std::printf("  %-12s lookup %7.1f ns/op  (found %zu)\n", name,
+              lookup_time * 1e9 / probes.size(), found);
+}
+
+template <typename Key>
+void Run(size_t count) {
+  std::mt19937_64 generator(42);
+  std::vector<Key> keys(count);
+  for (Key &key : keys) {
+    key = static_cast<Key>(generator());
+  }
+  std::vector<Key> probes(count);
+  for (size_t i = 0; i < count; i++) {
+    probes[i] = i % 2 ? keys[generator() % count]
+                      : static_cast<Key>(generator());
+  }
+  s21::S21Set<Key> set;
+  s21::S21BTreeSet<Key> btree;
+  for (const Key &key : keys) {
+    set.insert(key);
+    btree.insert(key);
+  }
+  auto start = Clock::now();
+  s21::FrozenSet<Key> frozen = s21::freeze(set);
+  double freeze_time = SecondsSince(start);
+  std::printf("%zu random %zu-bit keys, freeze %.1f ns/elem\n", count,
+              sizeof(Key) * 8, freeze_time * 1e9 / frozen.size());
+  Lookup("S21Set", set, probes);
+  Lookup("S21BTreeSet", btree, probes);
+  Lookup("FrozenSet", frozen, probes);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  Run<uint32_t>(count);
+  Run<uint64_t>(count);
+  return 0;
+}
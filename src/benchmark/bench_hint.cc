@@ -0,0 +1,109 @@
+// Plain versus hinted insertion into S21Set for ascending keys (hint
+// end()), descending keys (hint begin()) and random keys whose correct
+// successor is known in advance.
+//
+//   make bench
+//   ./benchmark/bench_hint 5000000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Set = s21::S21Set<uint64_t>;
+
+double NanosecondsPer(Clock::time_point start, size_t count) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         count;
+}
+
+void Report(const char *pattern, double plain, double hinted) {
+  std::printf("%-22s plain %7.1f ns/op  hinted %7.1f ns/op  (x%.2f)\n",
+              pattern, plain, hinted, plain / hinted);
+}
+
+void Ascending(size_t count) {
+  Set plain_set;
+  auto start = Clock::now();
+  for (uint64_t i = 0; i < count; i++) {
+    plain_set.insert(i);
+  }
+  double plain = NanosecondsPer(start, count);
+  Set hinted_set;
+  start = Clock::now();
+  for (uint64_t i = 0; i < count; i++) {
+    hinted_set.insert(hinted_set.end(), i);
+  }
+  Report("ascending, end()", plain, NanosecondsPer(start, count));
+}
+
+void Descending(size_t count) {
+  Set plain_set;
+  auto start = Clock::now();
+  for (uint64_t i = count; i > 0; i--) {
+    plain_set.insert(i);
+  }
+  double plain = NanosecondsPer(start, count);
+  Set hinted_set;
+  start = Clock::now();
+  for (uint64_t i = count; i > 0; i--) {
+    hinted_set.insert(hinted_set.begin(), i);
+  }
+  Report("descending, begin()", plain, NanosecondsPer(start, count));
+}
+
+// Odd keys are inserted in random order into a set of even keys; the hint
+// for 2i + 1 is the node of 2i + 2, collected before any insertion.
+void RandomWithHint(size_t count) {
+  std::vector<uint64_t> evens(count);
+  for (size_t i = 0; i < count; i++) {
+    evens[i] = 2 * i;
+  }
+  std::vector<size_t> order(count);
+  for (size_t i = 0; i < count; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+  Set plain_set;
+  plain_set.load_sorted(evens.begin(), evens.end());
+  auto start = Clock::now();
+  for (size_t i : order) {
+    plain_set.insert(2 * i + 1);
+  }
+  double plain = NanosecondsPer(start, count);
+
+  Set hinted_set;
+  hinted_set.load_sorted(evens.begin(), evens.end());
+  std::vector<Set::const_iterator> successors;
+  successors.reserve(count);
+  for (auto it = ++hinted_set.begin(); it != hinted_set.end(); ++it) {
+    successors.push_back(it);
+  }
+  successors.push_back(hinted_set.end());
+  start = Clock::now();
+  for (size_t i : order) {
+    hinted_set.insert(successors[i], 2 * i + 1);
+  }
+  Report("random, correct hint", plain, NanosecondsPer(start, count));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::printf("%zu insertions\n", count);
+  Ascending(count);
+  Descending(count);
+  RandomWithHint(count);
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Merging a sorted batch into a large set: a loop of insert calls versus
+// insert_sorted, which starts each descent from the node the previous key
+// landed on, for batches of a thousand to 1 million keys.
+//
+//   make bench
+//   ./benchmark/bench_insert_sorted 1000000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Set = s21::S21Set<uint64_t>;
+
+double NanosPerKey(Clock::time_point start, size_t keys) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+             .count() /
+         keys;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::mt19937_64 random(42);
+  std::vector<uint64_t> keys(count);
+  for (uint64_t &key : keys) {
+    key = random() % (count * 4);
+  }
+
+  std::printf("%zu-key set, sorted batches\n", count);
+  std::printf("%8s %14s %18s %8s\n", "batch", "insert ns/key",
+              "insert_sorted ns", "speedup");
+  bool agree = true;
+  for (size_t batch = 1000; batch <= 1000000; batch *= 10) {
+    std::vector<uint64_t> run(batch);
+    for (uint64_t &key : run) {
+      key = random() % (count * 4);
+    }
+    std::sort(run.begin(), run.end());
+
+    Set looped;
+    looped.load(keys.begin(), keys.end());
+    auto start = Clock::now();
+    for (uint64_t key : run) {
+      looped.insert(key);
+    }
+    double loop = NanosPerKey(start, batch);
+
+    Set merged;
+    merged.load(keys.begin(), keys.end());
+    start = Clock::now();
+    merged.insert_sorted(run.begin(), run.end());
+    double sorted = NanosPerKey(start, batch);
+    agree = agree && looped.size() == merged.size();
+    std::printf("%8zu %14.1f %18.1f %7.2fx\n", batch, loop, sorted,
+                loop / sorted);
+  }
+  return agree ? 0 : 1;
+}
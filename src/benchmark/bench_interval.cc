@@ -0,0 +1,90 @@
+// Overlap queries over many short intervals and a few long ones: scanning
+// a plain vector versus S21IntervalSet, which skips every subtree ending
+// before the query starts.
+//
+//   make bench
+//   ./benchmark/bench_interval 1000000 100
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Interval = std::pair<uint64_t, uint64_t>;
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  uint64_t width = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+  constexpr size_t queries = 2000;
+  const uint64_t span = count * 16;
+
+  std::mt19937_64 random(42);
+  std::vector<Interval> intervals;
+  intervals.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    uint64_t start = random() % span;
+    uint64_t length = i % 1000 ? random() % 64 : random() % 4096;
+    intervals.push_back({start, start + length + 1});
+  }
+  std::sort(intervals.begin(), intervals.end());
+  intervals.erase(std::unique(intervals.begin(), intervals.end()),
+                  intervals.end());
+  std::shuffle(intervals.begin(), intervals.end(), random);
+
+  s21::S21IntervalSet<uint64_t> set;
+  auto start = Clock::now();
+  set.load(intervals.begin(), intervals.end());
+  double build =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+      intervals.size();
+
+  random.seed(7);
+  size_t scanned_total = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < queries; i++) {
+    uint64_t low = random() % span;
+    uint64_t high = low + width;
+    scanned_total += std::count_if(
+        intervals.begin(), intervals.end(), [low, high](const Interval &v) {
+          return v.first < high && low < v.second;
+        });
+  }
+  double scan =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      queries;
+
+  random.seed(7);
+  size_t found_total = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < queries; i++) {
+    uint64_t low = random() % span;
+    set.for_each_overlapping(low, low + width,
+                             [&found_total](const Interval &) {
+                               found_total++;
+                             });
+  }
+  double query =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      queries;
+
+  std::printf("%zu intervals, windows of %llu, %.1f ns/load\n",
+              intervals.size(), static_cast<unsigned long long>(width), build);
+  std::printf("linear scan          %9.2f us/query\n", scan);
+  std::printf("for_each_overlapping %9.2f us/query  (x%.0f)\n", query,
+              scan / query);
+  bool agree = set.size() == intervals.size() && scanned_total == found_total;
+  return agree ? 0 : 1;
+}
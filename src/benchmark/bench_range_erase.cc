@@ -0,0 +1,67 @@
+// Expiring time-bucketed entries: every tick erases the oldest keys of a
+// map, once by looping erase over iterators and once with erase_range.
+//
+//   make bench
+//   ./benchmark/bench_range_erase 2000000 1000
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../s21_containers.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Map = s21::S21Map<uint64_t, uint64_t>;
+
+Map Filled(size_t count) {
+  Map map;
+  for (uint64_t key = 0; key < count; key++) {
+    map.emplace_hint(map.end(), key, key);
+  }
+  return map;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+  size_t per_tick = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+  size_t ticks = count / per_tick / 2;
+
+  Map looped = Filled(count);
+  auto start = Clock::now();
+  for (size_t tick = 0; tick < ticks; tick++) {
+    uint64_t high = (tick + 1) * per_tick;
+    auto it = looped.begin();
+    while (it != looped.end() && it->first < high) {
+      auto next = it;
+      ++next;
+      looped.erase(it);
+      it = next;
+    }
+  }
+  double loop_time =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      ticks;
+
+  Map ranged = Filled(count);
+  start = Clock::now();
+  for (size_t tick = 0; tick < ticks; tick++) {
+    ranged.erase_range(tick * per_tick, (tick + 1) * per_tick);
+  }
+  double range_time =
+      std::chrono::duration<double, std::micro>(Clock::now() - start)
+          .count() /
+      ticks;
+
+  std::printf("%zu keys, %zu expired per tick, %zu ticks\n", count,
+              per_tick, ticks);
+  std::printf("erase loop   %9.1f us/tick\n", loop_time);
+  std::printf("erase_range  %9.1f us/tick  (x%.1f)\n", range_time,
+              loop_time / range_time);
+  return looped.size() == ranged.size() ? 0 : 1;
+}
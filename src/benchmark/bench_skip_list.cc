@@ -0,0 +1,106 @@
+// Throughput of a mutex-guarded S21Set against the lock-free
+// ConcurrentSkipListSet for 1 to 32 threads on a dedup-style mix: every
+// operation is an insert of a random key (most of them already present),
+// a lookup, or, for one in ten, an erase.
+//
+//   make bench                                  # 100k keys, 200k ops/thread
+//   ./benchmark/bench_skip_list 1000000 1000000
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class LockedSet {
+ public:
+  bool insert(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return set_.insert(key).second;
+  }
+  bool contains(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return set_.contains(key);
+  }
+  void erase(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = set_.find(key);
+    if (it != set_.end()) {
+      set_.erase(it);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  s21::S21Set<uint64_t> set_;
+};
+
+template <typename Set>
+double Run(Set &set, size_t keys, size_t ops, int threads) {
+  std::vector<std::thread> workers;
+  auto start = Clock::now();
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&set, keys, ops, t] {
+      std::mt19937_64 generator(t);
+      size_t hits = 0;
+      for (size_t i = 0; i < ops; i++) {
+        uint64_t key = generator() % keys;
+        switch (generator() % 10) {
+          case 0:
+            set.erase(key);
+            break;
+          case 1:
+          case 2:
+          case 3:
+          case 4:
+            hits += set.insert(key) ? 0 : 1;
+            break;
+          default:
+            hits += set.contains(key) ? 1 : 0;
+        }
+      }
+      if (hits == ops + 1) {
+        std::printf("unreachable\n");
+      }
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return threads * ops / seconds / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  size_t ops = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+  std::printf("%zu keys, %zu ops per thread, %u hardware threads\n", keys,
+              ops, std::thread::hardware_concurrency());
+  std::printf("%-7s %12s %16s\n", "threads", "mutex Mops/s",
+              "lock-free Mops/s");
+  for (int threads : {1, 2, 4, 8, 16, 32}) {
+    LockedSet locked;
+    s21::ConcurrentSkipListSet<uint64_t> lock_free;
+    for (size_t key = 0; key < keys; key += 2) {
+      locked.insert(key);
+      lock_free.insert(key);
+    }
+    double locked_rate = Run(locked, keys, ops, threads);
+    double lock_free_rate = Run(lock_free, keys, ops, threads);
+    std::printf("%-7d %12.2f %16.2f\n", threads, locked_rate,
+                lock_free_rate);
+  }
+  return 0;
+}
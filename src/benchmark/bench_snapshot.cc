@@ -0,0 +1,64 @@
+// Cost of taking a read-only view of a table once per batch of updates:
+// a deep copy of S21Map against a snapshot of PersistentMap, which shares
+// every node and path-copies only what the next batch touches.
+//
+//   make bench                          # 1M entries
+//   ./benchmark/bench_snapshot 10000000 # 10M entries
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+constexpr int batches = 20;
+constexpr int updates_per_batch = 1000;
+
+template <typename Map>
+void Run(const char *name, size_t count) {
+  std::mt19937_64 generator(42);
+  Map table;
+  for (size_t i = 0; i < count; i++) {
+    table.insert(static_cast<uint64_t>(i), 0);
+  }
+  double snapshot_time = 0;
+  double update_time = 0;
+  uint64_t checksum = 0;
+  for (int batch = 0; batch < batches; batch++) {
+    auto start = Clock::now();
+    Map view = table;
+    snapshot_time += SecondsSince(start);
+    start = Clock::now();
+    for (int i = 0; i < updates_per_batch; i++) {
+      table.insert_or_assign(generator() % count, batch);
+    }
+    update_time += SecondsSince(start);
+    checksum += view.size();
+  }
+  std::printf("%-15s snapshot %10.1f us  update %7.1f ns/op  (checksum %llu)\n",
+              name, snapshot_time * 1e6 / batches,
+              update_time * 1e9 / (batches * updates_per_batch),
+              static_cast<unsigned long long>(checksum));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::printf("%zu entries, %d batches of %d updates\n", count, batches,
+              updates_per_batch);
+  Run<s21::S21Map<uint64_t, int>>("S21Map", count);
+  Run<s21::PersistentMap<uint64_t, int>>("PersistentMap", count);
+  return 0;
+}
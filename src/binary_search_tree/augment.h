@@ -0,0 +1,115 @@
+#ifndef CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_AUGMENT_H_
+#define CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_AUGMENT_H_
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace s21 {
+
+// Augmentation policies for BinarySearchTree. Every node keeps the
+// summary of its subtree, so a query over any range of positions combines
+// O(log n) stored summaries instead of visiting each element. A policy is
+// stateless and provides
+//
+//   using summary_type = ...;
+//   static summary_type identity();
+//   static summary_type summarize(const value_type &value);
+//   static summary_type combine(const summary_type &left,
+//                               const summary_type &right);
+//
+// where combine is associative with identity as its neutral element; it
+// is always called with the left operand ordered first, so it need not be
+// commutative. None of them may throw.
+
+// The default: nodes keep no summary, and no work is done to maintain it.
+struct NoAugment {
+  struct summary_type {};
+};
+
+// Projections picking the part of an element a policy summarizes.
+struct ProjectValue {
+  template <typename V>
+  const V &operator()(const V &value) const noexcept {
+    return value;
+  }
+};
+
+struct ProjectKey {
+  template <typename Entry>
+  const auto &operator()(const Entry &entry) const noexcept {
+    return entry.first;
+  }
+};
+
+struct ProjectMapped {
+  template <typename Entry>
+  const auto &operator()(const Entry &entry) const noexcept {
+    return entry.second;
+  }
+};
+
+template <typename Summary, typename Project = ProjectValue>
+struct SumAugment {
+  using summary_type = Summary;
+  using projection = Project;
+  static summary_type identity() { return Summary(); }
+  template <typename V>
+  static summary_type summarize(const V &value) {
+    return static_cast<Summary>(Project()(value));
+  }
+  static summary_type combine(const Summary &left, const Summary &right) {
+    return left + right;
+  }
+};
+
+template <typename Summary, typename Project = ProjectValue>
+struct MinAugment {
+  using summary_type = Summary;
+  using projection = Project;
+  static summary_type identity() {
+    return std::numeric_limits<Summary>::max();
+  }
+  template <typename V>
+  static summary_type summarize(const V &value) {
+    return static_cast<Summary>(Project()(value));
+  }
+  static summary_type combine(const Summary &left, const Summary &right) {
+    return std::min(left, right);
+  }
+};
+
+template <typename Summary, typename Project = ProjectValue>
+struct MaxAugment {
+  using summary_type = Summary;
+  using projection = Project;
+  static summary_type identity() {
+    return std::numeric_limits<Summary>::lowest();
+  }
+  template <typename V>
+  static summary_type summarize(const V &value) {
+    return static_cast<Summary>(Project()(value));
+  }
+  static summary_type combine(const Summary &left, const Summary &right) {
+    return std::max(left, right);
+  }
+};
+
+// Whether a policy's summaries of map entries depend on the mapped value.
+// Only NoAugment and policies projecting the key are known not to; S21Map
+// hands out the mapped values of every other one read-only, since a write
+// it does not see would leave the summaries above the entry stale.
+template <typename Augment, typename = void>
+struct summarizes_mapped : std::true_type {};
+
+template <>
+struct summarizes_mapped<NoAugment> : std::false_type {};
+
+template <typename Augment>
+struct summarizes_mapped<Augment, std::void_t<typename Augment::projection>>
+    : std::bool_constant<
+          !std::is_same<typename Augment::projection, ProjectKey>::value> {};
+
+}  // namespace s21
+
+#endif
@@ -1,10 +1,21 @@
 #ifndef CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_BINARY_SEARCH_TREE_H_
 #define CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_BINARY_SEARCH_TREE_H_
 
+#include <algorithm>
 #include <cstddef>
-
-#include "../list/s21_list.h"
-#include "../stack/s21_stack.h"
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "augment.h"
+#include "node_arena.h"
 // #include "../s21_containers.h"
 
 namespace s21 {
@@ -13,8 +24,33 @@ constexpr int bigger = 1;
 constexpr int smaller = -1;
 constexpr int right_side = 1;
 constexpr int left_side = -1;
-template <typename T>
 
+// Comparators may be less-style (returning bool, like std::less) or
+// three-way (returning a signed integer, negative/zero/positive).
+template <typename Compare, typename A, typename B>
+inline bool compare_less(const Compare &comp, const A &a, const B &b) {
+  if constexpr (std::is_same<decltype(comp(a, b)), bool>::value) {
+    return comp(a, b);
+  } else {
+    return comp(a, b) < 0;
+  }
+}
+
+template <typename Compare, typename A, typename B>
+inline int compare_three_way(const Compare &comp, const A &a, const B &b) {
+  if constexpr (std::is_same<decltype(comp(a, b)), bool>::value) {
+    if (comp(a, b)) {
+      return smaller;
+    }
+    return comp(b, a) ? bigger : equal;
+  } else {
+    auto result = comp(a, b);
+    return result < 0 ? smaller : (result > 0 ? bigger : equal);
+  }
+}
+
+template <typename T, typename Compare = std::less<T>,
+          typename Augment = NoAugment>
 class BinarySearchTree {
   static constexpr long max_long = 9223372036854775807L;
 
@@ -23,46 +59,115 @@ class BinarySearchTree {
   class Iterator;
   using value_type = T;
   using size_type = size_t;
-  using iterator = BinarySearchTree<T>::Iterator;
+  using value_compare = Compare;
+  using augment_type = Augment;
+  using summary_type = typename Augment::summary_type;
+  using iterator = BinarySearchTree<T, Compare, Augment>::Iterator;
   typedef struct node {
    public:
     value_type info;
     node *right = nullptr;
     node *left = nullptr;
+    node *parent = nullptr;
     size_type left_descendents_amount = 0;
     size_type right_descendents_amount = 0;
+    int height = 1;
+    summary_type summary = summary_type();  // of the subtree, see augment.h
   } node;
+  using arena_type = NodeArena<node>;
+  class NodeHandle;
+  using node_type = NodeHandle;
   BinarySearchTree() noexcept;
-  BinarySearchTree(node *root,
-                   int (*custom_compare)(value_type a, value_type b)) noexcept;
-  BinarySearchTree(int (*custom_compare)(value_type a, value_type b)) noexcept;
+  explicit BinarySearchTree(std::shared_ptr<arena_type> arena) noexcept;
+  explicit BinarySearchTree(const Compare &comp) noexcept;
   BinarySearchTree(const BinarySearchTree &another);
   BinarySearchTree(BinarySearchTree &&another) noexcept;
   BinarySearchTree(std::initializer_list<value_type> const &items);
   ~BinarySearchTree();
   BinarySearchTree &operator=(const BinarySearchTree &another);
   BinarySearchTree &operator=(BinarySearchTree &&another) noexcept;
-  virtual std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
-      value_type &val, int insertion = 1);
-  virtual std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
-      value_type val, int insertion = 1);
-  virtual std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
-      node *val, int insertion = 1);
+  void assign(const BinarySearchTree &another, unsigned threads = 0);
+  std::pair<iterator, bool> insert(const value_type &val, int insertion = 1);
+  std::pair<iterator, bool> insert(value_type &&val, int insertion = 1);
+  virtual std::pair<iterator, bool> insert(node *val, int insertion = 1);
+  std::pair<iterator, bool> insert(node_type &&handle);
+  iterator insert(const ConstIterator &hint, const value_type &val);
+  iterator insert(const ConstIterator &hint, value_type &&val);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+  template <typename... Args>
+  iterator emplace_hint(const ConstIterator &hint, Args &&...args);
+  node_type extract(iterator pos) noexcept;
+  node_type extract(const value_type &val) noexcept;
   iterator find(const value_type &val) const noexcept;
+  // The lookups below also take any K the comparator can order against
+  // value_type, without converting it, when Compare::is_transparent is
+  // defined (std::less<> for instance).
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) const noexcept;
+  template <typename ForwardIt>
+  void load_sorted(ForwardIt first, ForwardIt last);
+  template <typename InputIt>
+  void load(InputIt first, InputIt last);
+  // Inserts a sorted run far faster than element by element. The second
+  // form writes whether each element was inserted to out, in input order.
+  // If constructing an element throws, a short run keeps (and reports)
+  // the elements before it; a long one inserts and reports nothing.
+  template <typename ForwardIt>
+  size_type insert_sorted(ForwardIt first, ForwardIt last);
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt insert_sorted(ForwardIt first, ForwardIt last, OutputIt out);
   void merge(BinarySearchTree &other);
   bool empty() const noexcept;
   size_type max_size() const noexcept;
   size_type size() const noexcept;
-  bool contains(value_type &val) const noexcept;
-  bool contains(value_type val) const noexcept;
+  bool contains(const value_type &val) const noexcept;
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key) const noexcept;
+  size_type count(const value_type &val) const noexcept;
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const noexcept;
+  iterator lower_bound(const value_type &val) const noexcept;
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) const noexcept;
+  iterator upper_bound(const value_type &val) const noexcept;
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) const noexcept;
+  std::pair<iterator, iterator> equal_range(
+      const value_type &val) const noexcept;
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K &key) const noexcept;
+  // Batched lookups: one result per key of [first, last), written to out
+  // in input order. The descents run interleaved, see descend_many_.
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const;
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt contains_many(ForwardIt first, ForwardIt last,
+                         OutputIt out) const;
+  iterator nth(size_type index) const noexcept;
+  size_type rank(const value_type &val) const noexcept;
+  size_type count_range(const value_type &low,
+                        const value_type &high) const noexcept;
+  value_compare value_comp() const { return comp_; }
+  std::shared_ptr<arena_type> arena() const noexcept { return arena_; }
   void swap(BinarySearchTree &another) noexcept;
   class ConstIterator {
    public:
-    ConstIterator(node *root) noexcept;
-    ConstIterator(node *root, int index);
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = long;
+    using pointer = const T *;
+    using reference = const T &;
+    ConstIterator(const BinarySearchTree *tree) noexcept;
     ConstIterator(const ConstIterator &another) noexcept;
     ConstIterator(ConstIterator &&another) noexcept;
-    ConstIterator(node *root, node *cur, long cur_index_) noexcept;
+    ConstIterator(const BinarySearchTree *tree, node *cur) noexcept;
     ConstIterator &operator=(const ConstIterator &another) noexcept;
     ConstIterator &operator=(ConstIterator &&another) noexcept;
     bool operator==(const ConstIterator &another) const;
@@ -71,659 +176,2426 @@ class BinarySearchTree {
     ConstIterator operator++(int) noexcept;
     ConstIterator &operator--() noexcept;
     ConstIterator operator--(int) noexcept;
-    ConstIterator &operator-(int) noexcept;
-    ConstIterator &operator+(int) noexcept;
-    value_type *operator->() noexcept;
-    value_type &operator*();
-    friend void BinarySearchTree<T>::erase(value_type value);
-    friend void BinarySearchTree<T>::erase(iterator to_delete);
+    ConstIterator &operator+=(difference_type n) noexcept;
+    ConstIterator &operator-=(difference_type n) noexcept;
+    ConstIterator operator+(difference_type n) const noexcept;
+    ConstIterator operator-(difference_type n) const noexcept;
+    difference_type operator-(const ConstIterator &another) const noexcept;
+    const value_type *operator->() const noexcept;
+    const value_type &operator*() const;
+    friend class BinarySearchTree<T, Compare, Augment>;
 
    protected:
-    node *find_node_by_index_(long index) noexcept;
-    long cur_index_;
+    size_type tree_size_() const noexcept;
+    difference_type position_() const noexcept;
+    node *tree_root_() const noexcept { return tree_ ? tree_->root_ : nullptr; }
     node *cur_;
-    node *root_;
+    // The owning tree, not its root: rotations move the root on most
+    // updates, and end() must still find the current one.
+    const BinarySearchTree *tree_;
   };
 
   class Iterator : public ConstIterator {
    public:
-    Iterator(node *root, int index) : ConstIterator(root, index) {}
-    Iterator(node *root, node *cur, long cur_index)
-        : ConstIterator(root, cur, cur_index) {}
-    Iterator(node *root) : ConstIterator(root) {}
+    using pointer = T *;
+    using reference = T &;
+    Iterator(const BinarySearchTree *tree, node *cur)
+        : ConstIterator(tree, cur) {}
+    Iterator(const BinarySearchTree *tree) : ConstIterator(tree) {}
     value_type *operator->();
     value_type &operator*();
+    Iterator operator+(long n) const noexcept {
+      Iterator it(*this);
+      it += n;
+      return it;
+    }  // the element n positions later, found in O(log n)
+    Iterator operator-(long n) const noexcept {
+      Iterator it(*this);
+      it -= n;
+      return it;
+    }  // the element n positions earlier, found in O(log n)
+    using ConstIterator::operator-;
+  };
+
+  // Owns a node detached from a tree (see extract). The node keeps its
+  // value and its arena alive, and can be re-inserted into any tree of
+  // the same type without copying the value.
+  class NodeHandle {
+   public:
+    NodeHandle() noexcept = default;
+    NodeHandle(const NodeHandle &) = delete;
+    NodeHandle(NodeHandle &&another) noexcept;
+    NodeHandle &operator=(const NodeHandle &) = delete;
+    NodeHandle &operator=(NodeHandle &&another) noexcept;
+    ~NodeHandle();
+    bool empty() const noexcept { return node_ == nullptr; }
+    explicit operator bool() const noexcept { return node_ != nullptr; }
+    value_type &value() const { return node_->info; }
+
+   private:
+    friend class BinarySearchTree<T, Compare, Augment>;
+    NodeHandle(node *n, std::shared_ptr<arena_type> arena) noexcept
+        : node_(n), arena_(std::move(arena)) {}
+    void reset_() noexcept;
+    node *node_ = nullptr;
+    std::shared_ptr<arena_type> arena_;
   };
 
   void clear();
-  void erase(value_type value);
+  void erase(const value_type &value);
   void erase(iterator to_delete);
+  iterator erase(const ConstIterator &first, const ConstIterator &last);
+  size_type erase_range(const value_type &low, const value_type &high);
+  template <typename Fn>
+  void for_each_in_range(const value_type &low, const value_type &high,
+                         Fn fn) const;
+  summary_type aggregate(const value_type &low,
+                         const value_type &high) const;
   Iterator begin() const noexcept;
   Iterator end() const noexcept;
 
  protected:
   node *root_;
-  int (*custom_compare_)(value_type a, value_type b) = nullptr;
-  long find_index_by_value_(value_type &a) const noexcept;
-  void insert_descendent_of_deleted_(value_type a);
-  void info_cp(node *destination, node *source) const noexcept;
-  node *find_node_by_value_(value_type &val) const noexcept;
-  std::pair<typename BinarySearchTree<value_type>::Iterator, bool>
+  node *leftmost_ = nullptr;
+  node *rightmost_ = nullptr;
+  Compare comp_ = Compare();
+  // Nodes come from this arena. It is created on first use and is either
+  // private to the tree or shared with other trees of the same type.
+  std::shared_ptr<arena_type> arena_;
+  long find_index_by_value_(const value_type &a) const noexcept;
+  template <typename Probe, typename Before>
+  size_type count_before_(const Probe &probe, Before before) const noexcept;
+  template <typename Probe, typename Before>
+  iterator first_not_before_(const Probe &probe,
+                             Before before) const noexcept;
+  template <typename Probe, typename Less>
+  iterator find_(const Probe &probe, Less less) const noexcept;
+  template <typename Probe, typename Less>
+  size_type count_(const Probe &probe, Less less) const noexcept;
+  // Descents run in lockstep groups of this many.
+  static constexpr size_type batch_width_ = 16;
+  template <typename ForwardIt, typename Less, typename Emit>
+  void descend_many_(ForwardIt first, ForwardIt last, Less less,
+                     Emit emit) const;
+  template <typename ForwardIt, typename OutputIt, typename Less>
+  OutputIt find_many_(ForwardIt first, ForwardIt last, OutputIt out,
+                      Less less) const;
+  template <typename ForwardIt, typename OutputIt, typename Less>
+  OutputIt contains_many_(ForwardIt first, ForwardIt last, OutputIt out,
+                          Less less) const;
+  static void prefetch_(const void *address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+  }
+  // Compares values with anything comp_ accepts on either side.
+  auto less_any_() const noexcept {
+    return [this](const auto &a, const auto &b) {
+      return compare_less(comp_, a, b);
+    };
+  }
+  node *node_at_(size_type index) const noexcept;
+  void erase_positions_(size_type from, size_type to) noexcept;
+  template <typename Fn>
+  void for_each_at_(size_type from, size_type to, Fn &fn) const;
+  summary_type aggregate_at_(size_type from, size_type to) const;
+  void info_cp(node *destination, const node *source) const noexcept;
+  void destroy_subtree_(node *root) noexcept;
+  template <typename ForwardIt>
+  void build_from_sorted_(ForwardIt first, ForwardIt last, bool unique);
+  // insert_sorted_ rebuilds the tree once the run is at least 1/ratio of it.
+  static constexpr size_type rebuild_ratio_ = 16;
+  template <typename ForwardIt, typename Report>
+  void insert_sorted_(ForwardIt first, ForwardIt last, bool unique,
+                      Report report);
+  template <typename ForwardIt, typename Report>
+  void finger_insert_(ForwardIt first, ForwardIt last, bool unique,
+                      Report report);
+  template <typename ForwardIt, typename Report>
+  void merge_rebuild_(ForwardIt first, ForwardIt last, size_type count,
+                      bool unique, Report report);
+  static node *link_balanced_(node *const *nodes, size_type count) noexcept;
+  template <typename ForwardIt>
+  node *build_balanced_(ForwardIt &it, ForwardIt last, size_type count,
+                        bool unique);
+  node *find_node_by_value_(const value_type &val) const noexcept;
+  std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
   insert_new_node_(node *new_node, int insertion = 0);
-  std::pair<node *, int> define_place_for_new_node_(value_type val,
-                                                    int insertion = 0);
-  int compare_(value_type a, value_type b) const;
-  node *construct_node_(value_type a) const noexcept {
-    node *n = new node;
-    n->info = a;
-    n->left_descendents_amount = 0;
-    n->right_descendents_amount = 0;
-    n->left = nullptr;
-    n->right = nullptr;
-    return n;
+  std::pair<node *, int> define_place_for_new_node_(const value_type &val);
+  // Where a unique insertion of a probe ends up: the node equal to it
+  // (side == equal), or the free child slot it belongs in. index is the
+  // in-order index of that node, or the one a node linked into the slot
+  // gets; it is summed on the way down, so no second pass is needed to
+  // build the iterator.
+  struct slot_ {
+    node *parent = nullptr;
+    int side = equal;
+    bool found() const noexcept { return side == equal && parent; }
+  };
+  template <typename Probe, typename Less>
+  slot_ find_slot_(const Probe &probe, Less less) const noexcept;
+  slot_ find_slot_(const value_type &val) const noexcept;
+  iterator iterator_at_(const slot_ &slot) const noexcept {
+    return Iterator(this, slot.parent);
+  }
+  iterator link_at_(const slot_ &slot, node *new_node) noexcept;
+  template <typename Arg>
+  std::pair<iterator, bool> insert_unique_(Arg &&val, int insertion = 1);
+  std::pair<node *, int> place_after_equals_(
+      const value_type &val) const noexcept;
+  bool place_by_hint_(const ConstIterator &hint, const value_type &val,
+                      bool unique,
+                      std::pair<node *, int> &place) const noexcept;
+  std::pair<node *, int> hint_place_(const ConstIterator &hint,
+                                     const value_type &val, bool unique);
+  template <typename Arg>
+  iterator insert_hint_value_(const ConstIterator &hint, Arg &&val,
+                              bool unique);
+  iterator insert_hint_node_(const ConstIterator &hint, node *new_node,
+                             bool unique);
+  int compare_(const value_type &a, const value_type &b) const {
+    return compare_three_way(comp_, a, b);
   }
+  bool less_(const value_type &a, const value_type &b) const {
+    return compare_less(comp_, a, b);
+  }
+  node *construct_node_(const value_type &a) { return emplace_node_(a); }
+  node *construct_node_(value_type &&a) {
+    return emplace_node_(std::move(a));
+  }
+  template <typename... Args>
+  node *emplace_node_(Args &&...args);
+  node *adopt_node_(node *n, std::shared_ptr<arena_type> &origin);
+  node *adopt_handle_(node_type &handle);
+  static node *node_of_(const ConstIterator &it) noexcept { return it.cur_; }
+  node *copy_subtree_(const node *source, node *parent, void *block,
+                      size_type index, int forks) const;
+  static void destroy_values_(node *root) noexcept;
+  void destroy_node_(node *n) noexcept;
+
+  // AVL balancing engine. Every structural change goes through
+  // link_node_ or unlink_node_, so heights and descendant counters stay
+  // exact for the whole root-to-node path.
+  static size_type subtree_size_(const node *n) noexcept;
+  static int height_(const node *n) noexcept;
+  static void update_node_(node *n) noexcept;
+  static constexpr bool augmented_ = !std::is_same<Augment, NoAugment>::value;
+  static summary_type summary_of_(const node *n) noexcept;
+  static void refresh_summary_(node *n) noexcept;
+  static void refresh_path_(node *n) noexcept;
+  static summary_type summary_between_(const node *t, size_type from,
+                                       size_type to) noexcept;
+  static node *leftmost_of_(node *n) noexcept;
+  static node *rightmost_of_(node *n) noexcept;
+  static node *next_node_(node *n) noexcept;
+  static node *prev_node_(node *n) noexcept;
+  long find_index_by_node_(const node *n) const noexcept;
+  void replace_child_(node *parent, node *old_child, node *new_child) noexcept;
+  node *rotate_left_(node *n) noexcept;
+  node *rotate_right_(node *n) noexcept;
+  void rebalance_from_(node *n) noexcept;
+  void rebalance_after_link_(node *n) noexcept;
+  void link_node_(node *parent, int side, node *new_node) noexcept;
+  void unlink_node_(node *n) noexcept;
+
+  // Join-based set algebra. Subtrees are split around a key and joined
+  // back in O(log n), so combining trees of sizes m <= n costs
+  // O(m log(n / m + 1)) and the two halves of every step are independent.
+  enum class set_operation { unite, intersect, subtract };
+  static constexpr size_type parallel_grain = 1 << 14;
+  // Nodes dropped by a set operation, chained through their parent links
+  // so that worker threads never touch the (single-threaded) arena.
+  struct node_chain_ {
+    node *head = nullptr;
+    node *tail = nullptr;
+    void push(node *n) noexcept;
+    void push_single(node *n) noexcept;
+    void append(node_chain_ &other) noexcept;
+  };
+  static node *rotate_subtree_left_(node *n) noexcept;
+  static node *rotate_subtree_right_(node *n) noexcept;
+  static node *attach_(node *left, node *key, node *right) noexcept;
+  static node *join_(node *left, node *key, node *right) noexcept;
+  static node *join_right_(node *left, node *key, node *right) noexcept;
+  static node *join_left_(node *left, node *key, node *right) noexcept;
+  static node *join2_(node *left, node *right) noexcept;
+  static node *split_last_(node *t, node *&rest) noexcept;
+  node *split_(node *t, const value_type &key, node *&left,
+               node *&right) const noexcept;
+  static void split_at_(node *t, size_type count, node *&left,
+                        node *&right) noexcept;
+  static int forks_for_(unsigned threads) noexcept;
+  node *combine_(node *a, node *b, set_operation op, int forks,
+                 node_chain_ &trash) const noexcept;
+  void combine_with_(BinarySearchTree &other, set_operation op,
+                     unsigned threads);
+  void rehome_(BinarySearchTree &other);
 };
 
-template <typename T>
-void BinarySearchTree<T>::swap(BinarySearchTree &another) noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::subtree_size_(const node *n) noexcept {
+  if (n == nullptr) {
+    return 0;
+  }
+  return n->left_descendents_amount + n->right_descendents_amount + 1;
+}
+
+template <typename T, typename Compare, typename Augment>
+int BinarySearchTree<T, Compare, Augment>::height_(const node *n) noexcept {
+  return n ? n->height : 0;
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::update_node_(node *n) noexcept {
+  n->left_descendents_amount = subtree_size_(n->left);
+  n->right_descendents_amount = subtree_size_(n->right);
+  int left_height = height_(n->left);
+  int right_height = height_(n->right);
+  n->height = (left_height > right_height ? left_height : right_height) + 1;
+  refresh_summary_(n);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::summary_type
+BinarySearchTree<T, Compare, Augment>::summary_of_(const node *n) noexcept {
+  return n ? n->summary : Augment::identity();
+}
+
+// Recomputes n's summary from its children's, which must be up to date.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::refresh_summary_(
+    node *n) noexcept {
+  if constexpr (augmented_) {
+    n->summary = Augment::combine(
+        Augment::combine(summary_of_(n->left), Augment::summarize(n->info)),
+        summary_of_(n->right));
+  }
+}
+
+// For a value changed in place: the summaries of n and its ancestors are
+// the only ones that depend on it.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::refresh_path_(node *n) noexcept {
+  if constexpr (augmented_) {
+    for (; n; n = n->parent) {
+      refresh_summary_(n);
+    }
+  }
+}
+
+// Summary of the elements of subtree t with positions [from, to), relative
+// to t. A subtree wholly inside the range contributes its stored summary,
+// so at most two root-to-leaf paths are walked.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::summary_type
+BinarySearchTree<T, Compare, Augment>::summary_between_(
+    const node *t, size_type from, size_type to) noexcept {
+  summary_type result = Augment::identity();
+  while (t && from < to) {
+    if (from == 0 && to >= subtree_size_(t)) {
+      return Augment::combine(result, t->summary);
+    }
+    size_type left_size = t->left_descendents_amount;
+    if (to <= left_size) {
+      t = t->left;
+    } else if (from > left_size) {
+      from -= left_size + 1;
+      to -= left_size + 1;
+      t = t->right;
+    } else {
+      result = Augment::combine(
+          Augment::combine(result, summary_between_(t->left, from, left_size)),
+          Augment::summarize(t->info));
+      from = 0;
+      to -= left_size + 1;
+      t = t->right;
+    }
+  }
+  return result;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::leftmost_of_(node *n) noexcept {
+  if (n == nullptr) {
+    return nullptr;
+  }
+  while (n->left) {
+    n = n->left;
+  }
+  return n;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::rightmost_of_(node *n) noexcept {
+  if (n == nullptr) {
+    return nullptr;
+  }
+  while (n->right) {
+    n = n->right;
+  }
+  return n;
+}
+
+// In-order neighbours through parent pointers: amortized O(1) per step over
+// a full traversal, since every edge is walked at most twice.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::next_node_(node *n) noexcept {
+  if (n->right) {
+    return leftmost_of_(n->right);
+  }
+  node *prev = n;
+  n = n->parent;
+  while (n && n->right == prev) {
+    prev = n;
+    n = n->parent;
+  }
+  return n;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::prev_node_(node *n) noexcept {
+  if (n->left) {
+    return rightmost_of_(n->left);
+  }
+  node *prev = n;
+  n = n->parent;
+  while (n && n->left == prev) {
+    prev = n;
+    n = n->parent;
+  }
+  return n;
+}
+
+template <typename T, typename Compare, typename Augment>
+long BinarySearchTree<T, Compare, Augment>::find_index_by_node_(
+    const node *n) const noexcept {
+  if (n == nullptr) {
+    return -1;
+  }
+  long index = n->left_descendents_amount;
+  while (n->parent) {
+    if (n == n->parent->right) {
+      index += n->parent->left_descendents_amount + 1;
+    }
+    n = n->parent;
+  }
+  return index;
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::replace_child_(
+    node *parent, node *old_child, node *new_child) noexcept {
+  if (parent == nullptr) {
+    root_ = new_child;
+  } else if (parent->left == old_child) {
+    parent->left = new_child;
+  } else {
+    parent->right = new_child;
+  }
+  if (new_child) {
+    new_child->parent = parent;
+  }
+}
+
+// Rotations of a detached subtree: the caller links the returned pivot to
+// whatever held n before.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::rotate_subtree_left_(node *n) noexcept {
+  node *pivot = n->right;
+  n->right = pivot->left;
+  if (pivot->left) {
+    pivot->left->parent = n;
+  }
+  pivot->left = n;
+  n->parent = pivot;
+  update_node_(n);
+  update_node_(pivot);
+  return pivot;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::rotate_subtree_right_(node *n) noexcept {
+  node *pivot = n->left;
+  n->left = pivot->right;
+  if (pivot->right) {
+    pivot->right->parent = n;
+  }
+  pivot->right = n;
+  n->parent = pivot;
+  update_node_(n);
+  update_node_(pivot);
+  return pivot;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::rotate_left_(node *n) noexcept {
+  node *parent = n->parent;
+  node *pivot = rotate_subtree_left_(n);
+  replace_child_(parent, n, pivot);
+  return pivot;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::rotate_right_(node *n) noexcept {
+  node *parent = n->parent;
+  node *pivot = rotate_subtree_right_(n);
+  replace_child_(parent, n, pivot);
+  return pivot;
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::rebalance_from_(node *n) noexcept {
+  while (n) {
+    update_node_(n);
+    int balance = height_(n->left) - height_(n->right);
+    if (balance > 1) {
+      if (height_(n->left->left) < height_(n->left->right)) {
+        rotate_left_(n->left);
+      }
+      n = rotate_right_(n);
+    } else if (balance < -1) {
+      if (height_(n->right->right) < height_(n->right->left)) {
+        rotate_right_(n->right);
+      }
+      n = rotate_left_(n);
+    }
+    n = n->parent;
+  }
+}
+
+// Same as rebalance_from_ for a path that just gained one leaf. Once a
+// subtree's height is back to what it was, no ancestor can change height
+// or rotate, so the rest of the path only has a counter bumped instead of
+// being recomputed from both children.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::rebalance_after_link_(
+    node *n) noexcept {
+  while (n) {
+    int old_height = n->height;
+    update_node_(n);
+    int balance = height_(n->left) - height_(n->right);
+    if (balance > 1) {
+      if (height_(n->left->left) < height_(n->left->right)) {
+        rotate_left_(n->left);
+      }
+      n = rotate_right_(n);
+    } else if (balance < -1) {
+      if (height_(n->right->right) < height_(n->right->left)) {
+        rotate_right_(n->right);
+      }
+      n = rotate_left_(n);
+    }
+    if (n->height == old_height) {
+      for (node *parent = n->parent; parent; n = parent, parent = n->parent) {
+        if (parent->left == n) {
+          parent->left_descendents_amount++;
+        } else {
+          parent->right_descendents_amount++;
+        }
+        refresh_summary_(parent);
+      }
+      return;
+    }
+    n = n->parent;
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::link_node_(
+    node *parent, int side, node *new_node) noexcept {
+  new_node->parent = parent;
+  refresh_summary_(new_node);
+  if (parent == nullptr) {
+    root_ = new_node;
+    leftmost_ = new_node;
+    rightmost_ = new_node;
+    return;
+  }
+  if (side == right_side) {
+    parent->right = new_node;
+    if (parent == rightmost_) {
+      rightmost_ = new_node;
+    }
+  } else {
+    parent->left = new_node;
+    if (parent == leftmost_) {
+      leftmost_ = new_node;
+    }
+  }
+  rebalance_after_link_(parent);
+}
+
+// Detaches n without touching any other node's value: a node with two
+// children is replaced by its in-order successor, which is relinked into
+// its place. Only the path from the lowest relinked node to the root has
+// its counters and heights recomputed.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::unlink_node_(node *n) noexcept {
+  if (n == leftmost_) {
+    leftmost_ = next_node_(n);
+  }
+  if (n == rightmost_) {
+    rightmost_ = prev_node_(n);
+  }
+  node *rebalance_start = nullptr;
+  if (n->left && n->right) {
+    node *successor = leftmost_of_(n->right);
+    if (successor->parent != n) {
+      rebalance_start = successor->parent;
+      replace_child_(successor->parent, successor, successor->right);
+      successor->right = n->right;
+      successor->right->parent = successor;
+    } else {
+      rebalance_start = successor;
+    }
+    replace_child_(n->parent, n, successor);
+    successor->left = n->left;
+    successor->left->parent = successor;
+  } else {
+    rebalance_start = n->parent;
+    replace_child_(n->parent, n, n->left ? n->left : n->right);
+  }
+  rebalance_from_(rebalance_start);
+  n->parent = nullptr;
+  n->left = nullptr;
+  n->right = nullptr;
+  n->left_descendents_amount = 0;
+  n->right_descendents_amount = 0;
+  n->height = 1;
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::node_chain_::push(
+    node *n) noexcept {
+  n->parent = head;
+  head = n;
+  if (tail == nullptr) {
+    tail = n;
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::node_chain_::push_single(
+    node *n) noexcept {
+  n->left = nullptr;
+  n->right = nullptr;
+  push(n);
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::node_chain_::append(
+    node_chain_ &other) noexcept {
+  if (other.head == nullptr) {
+    return;
+  }
+  other.tail->parent = head;
+  head = other.head;
+  if (tail == nullptr) {
+    tail = other.tail;
+  }
+  other.head = nullptr;
+  other.tail = nullptr;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::attach_(node *left, node *key,
+                                               node *right) noexcept {
+  key->left = left;
+  key->right = right;
+  if (left) {
+    left->parent = key;
+  }
+  if (right) {
+    right->parent = key;
+  }
+  update_node_(key);
+  return key;
+}
+
+// Joins two AVL trees with every key of left below key and every key of
+// right above it. The shorter tree is attached along the spine of the
+// taller one, so the cost is O(|height(left) - height(right)| + 1).
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::join_(node *left, node *key,
+                                             node *right) noexcept {
+  if (height_(left) > height_(right) + 1) {
+    return join_right_(left, key, right);
+  }
+  if (height_(right) > height_(left) + 1) {
+    return join_left_(left, key, right);
+  }
+  return attach_(left, key, right);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::join_right_(node *left, node *key,
+                                                   node *right) noexcept {
+  node *spine = left->right;
+  node *joined = nullptr;
+  if (height_(spine) <= height_(right) + 1) {
+    joined = attach_(spine, key, right);
+    if (height_(joined) > height_(left->left) + 1) {
+      joined = rotate_subtree_right_(joined);
+    }
+  } else {
+    joined = join_right_(spine, key, right);
+  }
+  attach_(left->left, left, joined);
+  if (height_(joined) > height_(left->left) + 1) {
+    return rotate_subtree_left_(left);
+  }
+  return left;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::join_left_(node *left, node *key,
+                                                  node *right) noexcept {
+  node *spine = right->left;
+  node *joined = nullptr;
+  if (height_(spine) <= height_(left) + 1) {
+    joined = attach_(left, key, spine);
+    if (height_(joined) > height_(right->right) + 1) {
+      joined = rotate_subtree_left_(joined);
+    }
+  } else {
+    joined = join_left_(left, key, spine);
+  }
+  attach_(joined, right, right->right);
+  if (height_(joined) > height_(right->right) + 1) {
+    return rotate_subtree_right_(right);
+  }
+  return right;
+}
+
+// Joins two trees without a separating key by borrowing the last node of
+// left.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::join2_(node *left,
+                                              node *right) noexcept {
+  if (left == nullptr) {
+    return right;
+  }
+  node *rest = nullptr;
+  node *last = split_last_(left, rest);
+  return join_(rest, last, right);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::split_last_(node *t,
+                                                   node *&rest) noexcept {
+  if (t->right == nullptr) {
+    rest = t->left;
+    return t;
+  }
+  node *right_rest = nullptr;
+  node *last = split_last_(t->right, right_rest);
+  rest = join_(t->left, t, right_rest);
+  return last;
+}
+
+// Splits t into the keys below and above key. The node equal to key, if
+// any, is returned detached from both halves.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::split_(node *t, const value_type &key,
+                                              node *&left,
+                                              node *&right) const noexcept {
+  if (t == nullptr) {
+    left = nullptr;
+    right = nullptr;
+    return nullptr;
+  }
+  node *t_left = t->left;
+  node *t_right = t->right;
+  int comparison = compare_(key, t->info);
+  if (comparison == equal) {
+    left = t_left;
+    right = t_right;
+    return t;
+  }
+  node *match = nullptr;
+  if (comparison == smaller) {
+    node *middle = nullptr;
+    match = split_(t_left, key, left, middle);
+    right = join_(middle, t, t_right);
+  } else {
+    node *middle = nullptr;
+    match = split_(t_right, key, middle, right);
+    left = join_(t_left, t, middle);
+  }
+  return match;
+}
+
+// Splits t into its first count elements and the rest, steering by the
+// subtree counters instead of comparisons. Subtrees that fall entirely on
+// one side are handed over whole.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::split_at_(node *t, size_type count,
+                                                      node *&left,
+                                                      node *&right) noexcept {
+  if (count == 0 || count >= subtree_size_(t)) {
+    left = count ? t : nullptr;
+    right = count ? nullptr : t;
+    return;
+  }
+  node *t_left = t->left;
+  node *t_right = t->right;
+  node *middle = nullptr;
+  if (count <= t->left_descendents_amount) {
+    split_at_(t_left, count, left, middle);
+    right = join_(middle, t, t_right);
+  } else {
+    split_at_(t_right, count - t->left_descendents_amount - 1, middle,
+              right);
+    left = join_(t_left, t, middle);
+  }
+}
+
+// Levels of recursion that may fork a thread so that about threads
+// workers run at once; threads == 0 uses every hardware thread.
+template <typename T, typename Compare, typename Augment>
+int BinarySearchTree<T, Compare, Augment>::forks_for_(
+    unsigned threads) noexcept {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  int forks = 0;
+  while (forks < 16 && (1U << forks) < threads) {
+    forks++;
+  }
+  return forks;
+}
+
+// One step splits a around the root of b and recurses on the two halves,
+// which share no nodes; the left half runs on its own thread while forks
+// remain and the halves are large enough to pay for it.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::combine_(
+    node *a, node *b, set_operation op, int forks,
+    node_chain_ &trash) const noexcept {
+  if (a == nullptr || b == nullptr) {
+    node *rest = a ? a : b;
+    if (rest == nullptr || op == set_operation::unite ||
+        (op == set_operation::subtract && a)) {
+      return rest;
+    }
+    trash.push(rest);
+    return nullptr;
+  }
+  node *b_left = b->left;
+  node *b_right = b->right;
+  node *a_left = nullptr;
+  node *a_right = nullptr;
+  node *match = split_(a, b->info, a_left, a_right);
+  node *key = nullptr;
+  if (op == set_operation::unite) {
+    key = match ? match : b;
+  } else if (op == set_operation::intersect) {
+    key = match;
+  } else if (match) {
+    trash.push_single(match);
+  }
+  if (key != b) {
+    trash.push_single(b);
+  }
+  node *left = nullptr;
+  node *right = nullptr;
+  if (forks > 0 &&
+      subtree_size_(a_left) + subtree_size_(b_left) >= parallel_grain &&
+      subtree_size_(a_right) + subtree_size_(b_right) >= parallel_grain) {
+    node_chain_ left_trash;
+    std::future<node *> left_task;
+    try {
+      left_task = std::async(std::launch::async, [&] {
+        return combine_(a_left, b_left, op, forks - 1, left_trash);
+      });
+    } catch (...) {
+    }
+    right = combine_(a_right, b_right, op, forks - 1, trash);
+    if (left_task.valid()) {
+      left = left_task.get();
+    } else {
+      left = combine_(a_left, b_left, op, forks - 1, left_trash);
+    }
+    trash.append(left_trash);
+  } else {
+    left = combine_(a_left, b_left, op, 0, trash);
+    right = combine_(a_right, b_right, op, 0, trash);
+  }
+  return key ? join_(left, key, right) : join2_(left, right);
+}
+
+// Moves other's values into nodes of this tree's arena, so that the two
+// trees can exchange nodes.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::rehome_(BinarySearchTree &other) {
+  std::vector<value_type> values;
+  values.reserve(other.size());
+  for (node *cur = other.leftmost_; cur; cur = next_node_(cur)) {
+    values.push_back(std::move(cur->info));
+  }
+  other.clear();
+  other.arena_ = arena_;
+  other.build_from_sorted_(std::make_move_iterator(values.begin()),
+                           std::make_move_iterator(values.end()), false);
+}
+
+// Combines other into this tree; other is left empty. Nodes are relinked,
+// not copied, and dropped nodes are destroyed once all workers are done.
+// threads == 0 uses every hardware thread.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::combine_with_(
+    BinarySearchTree &other, set_operation op, unsigned threads) {
+  if (this == &other) {
+    if (op == set_operation::subtract) {
+      clear();
+    }
+    return;
+  }
+  if (!arena_) {
+    arena_ = other.arena_;
+  } else if (other.root_ && other.arena_ != arena_) {
+    rehome_(other);
+  }
+  node_chain_ trash;
+  root_ = combine_(root_, other.root_, op, forks_for_(threads), trash);
+  other.root_ = nullptr;
+  other.leftmost_ = nullptr;
+  other.rightmost_ = nullptr;
+  if (root_) {
+    root_->parent = nullptr;
+  }
+  leftmost_ = leftmost_of_(root_);
+  rightmost_ = rightmost_of_(root_);
+  for (node *cur = trash.head; cur;) {
+    node *next = cur->parent;
+    cur->parent = nullptr;
+    destroy_subtree_(cur);
+    cur = next;
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::swap(
+    BinarySearchTree &another) noexcept {
   node *tmp = root_;
   root_ = another.root_;
   another.root_ = tmp;
+  tmp = leftmost_;
+  leftmost_ = another.leftmost_;
+  another.leftmost_ = tmp;
+  tmp = rightmost_;
+  rightmost_ = another.rightmost_;
+  another.rightmost_ = tmp;
+  arena_.swap(another.arena_);
+  std::swap(comp_, another.comp_);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::find(
+    const value_type &val) const noexcept {
+  return find_(val, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::find(const K &key) const noexcept {
+  return find_(key, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+bool BinarySearchTree<T, Compare, Augment>::contains(
+    const K &key) const noexcept {
+  return find_(key, less_any_()) != end();
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::count(
+    const value_type &val) const noexcept {
+  return count_(val, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::count(const K &key) const noexcept {
+  return count_(key, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::lower_bound(
+    const value_type &val) const noexcept {
+  return first_not_before_(val, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::lower_bound(
+    const K &key) const noexcept {
+  return first_not_before_(key, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::upper_bound(
+    const value_type &val) const noexcept {
+  auto less = less_any_();
+  return first_not_before_(val, [&less](const auto &e, const auto &v) {
+    return !less(v, e);
+  });
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::upper_bound(
+    const K &key) const noexcept {
+  auto less = less_any_();
+  return first_not_before_(key, [&less](const auto &e, const auto &k) {
+    return !less(k, e);
+  });
+}
+
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::iterator,
+          typename BinarySearchTree<T, Compare, Augment>::iterator>
+BinarySearchTree<T, Compare, Augment>::equal_range(
+    const value_type &val) const noexcept {
+  return std::make_pair(lower_bound(val), upper_bound(val));
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::iterator,
+          typename BinarySearchTree<T, Compare, Augment>::iterator>
+BinarySearchTree<T, Compare, Augment>::equal_range(
+    const K &key) const noexcept {
+  return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+// The first element e with !before(e, probe), or end(); one descent,
+// O(log n).
+template <typename T, typename Compare, typename Augment>
+template <typename Probe, typename Before>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::first_not_before_(
+    const Probe &probe, Before before) const noexcept {
+  node *found = nullptr;
+  node *cur = root_;
+  while (cur) {
+    if (before(cur->info, probe)) {
+      cur = cur->right;
+    } else {
+      found = cur;
+      cur = cur->left;
+    }
+  }
+  return Iterator(this, found);
+}
+
+// The first element equivalent to probe under less, or end().
+template <typename T, typename Compare, typename Augment>
+template <typename Probe, typename Less>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::find_(const Probe &probe,
+                                             Less less) const noexcept {
+  iterator it = first_not_before_(probe, less);
+  if (it.cur_ && less(probe, it.cur_->info)) {
+    return end();
+  }
+  return it;
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename OutputIt>
+OutputIt BinarySearchTree<T, Compare, Augment>::find_many(ForwardIt first,
+                                                          ForwardIt last,
+                                                          OutputIt out) const {
+  return find_many_(first, last, out, less_any_());
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename OutputIt>
+OutputIt BinarySearchTree<T, Compare, Augment>::contains_many(
+    ForwardIt first, ForwardIt last, OutputIt out) const {
+  return contains_many_(first, last, out, less_any_());
+}
+
+// A lone descent stalls on a cache miss at every level, since the next
+// node is only known once the current one has arrived. Here up to
+// batch_width_ descents advance one level per round, each prefetching
+// the child it moves to, so their misses overlap instead of queueing;
+// the results match first_not_before_(probe, less). emit(probe, found)
+// is called per probe in input order, found being nullptr when every
+// element is ordered before the probe.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename Less, typename Emit>
+void BinarySearchTree<T, Compare, Augment>::descend_many_(ForwardIt first,
+                                                          ForwardIt last,
+                                                          Less less,
+                                                          Emit emit) const {
+  using probe_type = std::remove_reference_t<decltype(*first)>;
+  struct lane {
+    probe_type *probe;
+    node *cur;
+    node *found;
+  };
+  lane lanes[batch_width_];
+  while (first != last) {
+    size_type width = 0;
+    for (; first != last && width < batch_width_; ++first, ++width) {
+      lanes[width] = lane{&*first, root_, nullptr};
+    }
+    bool moving = root_ != nullptr;
+    while (moving) {
+      moving = false;
+      for (size_type i = 0; i < width; i++) {
+        lane &l = lanes[i];
+        if (l.cur == nullptr) {
+          continue;
+        }
+        if (less(l.cur->info, *l.probe)) {
+          l.cur = l.cur->right;
+        } else {
+          l.found = l.cur;
+          l.cur = l.cur->left;
+        }
+        if (l.cur) {
+          prefetch_(l.cur);
+          moving = true;
+        }
+      }
+    }
+    for (size_type i = 0; i < width; i++) {
+      emit(*lanes[i].probe, lanes[i].found);
+    }
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename OutputIt, typename Less>
+OutputIt BinarySearchTree<T, Compare, Augment>::find_many_(ForwardIt first,
+                                                           ForwardIt last,
+                                                           OutputIt out,
+                                                           Less less) const {
+  descend_many_(first, last, less,
+                [this, &out, &less](const auto &probe, node *found) {
+                  if (found == nullptr || less(probe, found->info)) {
+                    *out++ = end();
+                  } else {
+                    *out++ = Iterator(this, found);
+                  }
+                });
+  return out;
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename OutputIt, typename Less>
+OutputIt BinarySearchTree<T, Compare, Augment>::contains_many_(
+    ForwardIt first, ForwardIt last, OutputIt out, Less less) const {
+  descend_many_(first, last, less,
+                [&out, &less](const auto &probe, node *found) {
+                  *out++ = found != nullptr && !less(probe, found->info);
+                });
+  return out;
+}
+
+// Elements equivalent to probe, as the difference of two ranks, so
+// duplicates are counted in O(log n) however many there are.
+template <typename T, typename Compare, typename Augment>
+template <typename Probe, typename Less>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::count_(const Probe &probe,
+                                              Less less) const noexcept {
+  size_type below = count_before_(probe, less);
+  size_type up_to = count_before_(
+      probe, [&less](const auto &e, const auto &p) { return !less(p, e); });
+  return up_to - below;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::node_at_(
+    size_type index) const noexcept {
+  node *cur = root_;
+  while (cur && index != cur->left_descendents_amount) {
+    if (index < cur->left_descendents_amount) {
+      cur = cur->left;
+    } else {
+      index -= cur->left_descendents_amount + 1;
+      cur = cur->right;
+    }
+  }
+  return cur;
+}
+
+// Counts the elements e with before(e, probe), which must hold for a
+// prefix of the in-order sequence; one descent, O(log n).
+template <typename T, typename Compare, typename Augment>
+template <typename Probe, typename Before>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::count_before_(
+    const Probe &probe, Before before) const noexcept {
+  size_type count = 0;
+  node *cur = root_;
+  while (cur) {
+    if (before(cur->info, probe)) {
+      count += cur->left_descendents_amount + 1;
+      cur = cur->right;
+    } else {
+      cur = cur->left;
+    }
+  }
+  return count;
+}
+
+// The element with in-order index `index`, or end() past the last one.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::nth(size_type index) const noexcept {
+  node *n = index < size() ? node_at_(index) : nullptr;
+  if (n == nullptr) {
+    return end();
+  }
+  return Iterator(this, n);
+}
+
+// Number of elements ordered before val, i.e. the index val has or would
+// get.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::rank(
+    const value_type &val) const noexcept {
+  return count_before_(val, [this](const value_type &a, const value_type &b) {
+    return less_(a, b);
+  });
+}
+
+// Number of elements in [low, high).
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::count_range(
+    const value_type &low, const value_type &high) const noexcept {
+  size_type below_high = rank(high);
+  size_type below_low = rank(low);
+  return below_high > below_low ? below_high - below_low : 0;
+}
+
+template <typename T, typename Compare, typename Augment>
+bool BinarySearchTree<T, Compare, Augment>::contains(
+    const value_type &val) const noexcept {
+  if (find_node_by_value_(val) == nullptr) {
+    return false;
+  }
+  return true;
+}
+
+// The value is constructed directly in the node, from args.
+template <typename T, typename Compare, typename Augment>
+template <typename... Args>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::emplace_node_(Args &&...args) {
+  if (!arena_) {
+    arena_ = std::make_shared<arena_type>();
+  }
+  void *memory = arena_->allocate();
+  try {
+    return new (memory) node{value_type(std::forward<Args>(args)...)};
+  } catch (...) {
+    arena_->deallocate(memory);
+    throw;
+  }
+}
+
+// Takes over a detached node allocated from origin. Nodes from the same
+// arena (or any arena, while this tree has none yet) are used as is;
+// otherwise the value is moved into a node of this tree's arena. If that
+// allocation throws, n is left untouched.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::adopt_node_(
+    node *n, std::shared_ptr<arena_type> &origin) {
+  if (!arena_) {
+    arena_ = origin;
+  }
+  if (arena_ == origin) {
+    return n;
+  }
+  node *moved = construct_node_(std::move(n->info));
+  n->~node();
+  origin->deallocate(n);
+  return moved;
+}
+
+// Copies source into slots of one block laid out in preorder: a subtree
+// whose root takes slot index holds its left subtree from index + 1 and
+// its right one right after, so both halves know their slots in advance
+// and can be filled on different threads without touching the arena. On
+// a throw every value constructed here is destroyed again; the slots
+// stay with the caller.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::copy_subtree_(const node *source,
+                                                     node *parent, void *block,
+                                                     size_type index,
+                                                     int forks) const {
+  if (source == nullptr) {
+    return nullptr;
+  }
+  node *n = new (arena_type::slot_in_block(block, index)) node{source->info};
+  info_cp(n, source);
+  n->parent = parent;
+  size_type right_index = index + 1 + source->left_descendents_amount;
+  node *left = nullptr;
+  node *right = nullptr;
+  try {
+    if (forks > 0 && source->left_descendents_amount >= parallel_grain &&
+        source->right_descendents_amount >= parallel_grain) {
+      std::future<node *> left_task;
+      try {
+        left_task = std::async(std::launch::async, [=] {
+          return copy_subtree_(source->left, n, block, index + 1, forks - 1);
+        });
+      } catch (...) {
+      }
+      try {
+        right = copy_subtree_(source->right, n, block, right_index, forks - 1);
+      } catch (...) {
+        if (left_task.valid()) {
+          try {
+            destroy_values_(left_task.get());
+          } catch (...) {
+          }
+        }
+        throw;
+      }
+      try {
+        left = left_task.valid() ? left_task.get()
+                                 : copy_subtree_(source->left, n, block,
+                                                 index + 1, forks - 1);
+      } catch (...) {
+        destroy_values_(right);
+        throw;
+      }
+    } else {
+      left = copy_subtree_(source->left, n, block, index + 1, 0);
+      try {
+        right = copy_subtree_(source->right, n, block, right_index, 0);
+      } catch (...) {
+        destroy_values_(left);
+        throw;
+      }
+    }
+  } catch (...) {
+    n->~node();
+    throw;
+  }
+  n->left = left;
+  n->right = right;
+  return n;
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::destroy_values_(
+    node *root) noexcept {
+  if (root) {
+    destroy_values_(root->left);
+    destroy_values_(root->right);
+    root->~node();
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::destroy_node_(node *n) noexcept {
+  n->~node();
+  arena_->deallocate(n);
+}
+
+// Copies the bookkeeping (counters and height) but not the links or info.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::info_cp(
+    node *destination, const node *source) const noexcept {
+  destination->left_descendents_amount = source->left_descendents_amount;
+  destination->right_descendents_amount = source->right_descendents_amount;
+  destination->height = source->height;
+  destination->summary = source->summary;
+}
+
+// Moves every node whose value is not present here out of other and links
+// it into this tree. Nodes are relinked, never copied; when the trees use
+// different arenas the value is moved into a node of this tree's arena.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::merge(BinarySearchTree &other) {
+  if (this == &other) {
+    return;
+  }
+  node *cur = other.leftmost_;
+  while (cur) {
+    node *next = next_node_(cur);
+    std::pair<node *, int> place = define_place_for_new_node_(cur->info);
+    if (place.second != equal || place.first == nullptr) {
+      other.unlink_node_(cur);
+      node *adopted = nullptr;
+      try {
+        adopted = adopt_node_(cur, other.arena_);
+      } catch (...) {
+        other.insert_new_node_(cur, 1);
+        throw;
+      }
+      link_node_(place.first, place.second, adopted);
+    }
+    cur = next;
+  }
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::find(
-    const value_type &val) const noexcept {
-  value_type value = val;
-  node *cur = find_node_by_value_(value);
-  if (cur == nullptr) {
-    Iterator it(root_);
-    return it;
-  } else {
-    Iterator it(root_, cur, find_index_by_value_(cur->info));
-    return it;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node_type
+BinarySearchTree<T, Compare, Augment>::extract(iterator pos) noexcept {
+  if (pos.cur_ == nullptr) {
+    return node_type();
   }
+  unlink_node_(pos.cur_);
+  return node_type(pos.cur_, arena_);
 }
 
-template <typename T>
-bool BinarySearchTree<T>::contains(value_type &val) const noexcept {
-  if (find_node_by_value_(val) == nullptr) {
-    return false;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node_type
+BinarySearchTree<T, Compare, Augment>::extract(const value_type &val) noexcept {
+  node *found = find_node_by_value_(val);
+  if (found == nullptr) {
+    return node_type();
   }
-  return true;
+  unlink_node_(found);
+  return node_type(found, arena_);
 }
 
-template <typename T>
-bool BinarySearchTree<T>::contains(value_type val) const noexcept {
-  if (find_node_by_value_(val) == nullptr) {
-    return false;
+// Links the handle's node unless an equal value is already present, in
+// which case the handle keeps its node.
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert(node_type &&handle) {
+  if (handle.empty()) {
+    return std::make_pair(end(), false);
   }
-  return true;
+  slot_ slot = find_slot_(handle.value());
+  if (slot.found()) {
+    return std::make_pair(iterator_at_(slot), false);
+  }
+  return std::make_pair(link_at_(slot, adopt_handle_(handle)), true);
 }
 
-template <typename T>
-void BinarySearchTree<T>::info_cp(node *destination,
-                                  node *source) const noexcept {
-  destination->info = source->info;
-  destination->left_descendents_amount = source->left_descendents_amount;
-  destination->right_descendents_amount = source->right_descendents_amount;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::adopt_handle_(node_type &handle) {
+  node *adopted = adopt_node_(handle.node_, handle.arena_);
+  handle.node_ = nullptr;
+  handle.arena_.reset();
+  return adopted;
 }
 
-template <typename T>
-void BinarySearchTree<T>::insert_descendent_of_deleted_(value_type a) {
-  node *to_ins = construct_node_(a);
-  insert_new_node_(to_ins);
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::NodeHandle::NodeHandle(
+    NodeHandle &&another) noexcept
+    : node_(another.node_), arena_(std::move(another.arena_)) {
+  another.node_ = nullptr;
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(
-    node *root, int (*custom_compare)(value_type a, value_type b)) noexcept {
-  root_ = root;
-  custom_compare_ = custom_compare;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::NodeHandle &
+BinarySearchTree<T, Compare, Augment>::NodeHandle::operator=(
+    NodeHandle &&another) noexcept {
+  if (this != &another) {
+    reset_();
+    node_ = another.node_;
+    arena_ = std::move(another.arena_);
+    another.node_ = nullptr;
+  }
+  return *this;
 }
 
-template <typename T>
-int BinarySearchTree<T>::compare_(BinarySearchTree<T>::value_type a,
-                                  BinarySearchTree<T>::value_type b) const {
-  if (custom_compare_ == nullptr) {
-    if (a > b) {
-      return bigger;
-    }
-    if (a < b) {
-      return smaller;
-    }
-    if (a == b) {
-      return equal;
-    }
-  }
-  return (*custom_compare_)(a, b);
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::NodeHandle::~NodeHandle() {
+  reset_();
 }
 
-template <typename T>
-void BinarySearchTree<T>::merge(BinarySearchTree &other) {
-  S21List<value_type> to_erase;
-  for (auto it = other.begin(); it != other.end(); it++) {
-    if (insert(std::move(*it)).second) {
-      to_erase.push_front(*it);
-    }
-  }
-  for (auto it = to_erase.begin(); it != to_erase.end(); it++) {
-    other.erase(*it);
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::NodeHandle::reset_() noexcept {
+  if (node_) {
+    node_->~node();
+    arena_->deallocate(node_);
+    node_ = nullptr;
   }
+  arena_.reset();
 }
 
-template <typename T>
-BinarySearchTree<T>::~BinarySearchTree() {
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::~BinarySearchTree() {
   clear();
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree() noexcept {
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree() noexcept {
+  root_ = nullptr;
+}
+
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree(
+    std::shared_ptr<arena_type> arena) noexcept
+    : arena_(std::move(arena)) {
   root_ = nullptr;
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(
-    int (*custom_compare)(value_type a, value_type b)) noexcept {
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree(
+    const Compare &comp) noexcept
+    : comp_(comp) {
   root_ = nullptr;
-  custom_compare_ = custom_compare;
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(BinarySearchTree &&another) noexcept {
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree(
+    BinarySearchTree &&another) noexcept {
   root_ = another.root_;
-  custom_compare_ = another.custom_compare_;
+  leftmost_ = another.leftmost_;
+  rightmost_ = another.rightmost_;
+  comp_ = another.comp_;
+  arena_ = std::move(another.arena_);
   another.root_ = nullptr;
-  another.custom_compare_ = nullptr;
+  another.leftmost_ = nullptr;
+  another.rightmost_ = nullptr;
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree(
     std::initializer_list<value_type> const &items) {
   root_ = nullptr;
-  for (auto it = items.begin(); it != items.end(); it++) {
-    node *new_node = construct_node_(*it);
-    insert_new_node_(new_node, 1);
-  }
+  load(items.begin(), items.end());
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(BinarySearchTree const &another) {
-  root_ = nullptr;
-  *this = another;
+// Replaces the contents with an already sorted range in O(n): the tree is
+// built bottom-up in one in-order pass, perfectly balanced, with exact
+// descendant counters. Duplicates keep their first occurrence. Throws
+// std::invalid_argument (leaving the tree untouched) if the range is not
+// sorted. Each element is read once after the check, so move iterators
+// over the range move it into the tree.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt>
+void BinarySearchTree<T, Compare, Augment>::load_sorted(ForwardIt first,
+                                                        ForwardIt last) {
+  build_from_sorted_(first, last, true);
 }
 
-template <typename T>
-BinarySearchTree<T> &BinarySearchTree<T>::operator=(
-    BinarySearchTree const &another) {
-  clear();
-  if (another.root_ == nullptr) {
-    root_ = nullptr;
-    return *this;
+// Same as load_sorted for input in any order: it is copied and sorted
+// first, so the whole load costs O(n log n). The sorted copies are moved
+// into the nodes; pass move iterators to move the input as well.
+template <typename T, typename Compare, typename Augment>
+template <typename InputIt>
+void BinarySearchTree<T, Compare, Augment>::load(InputIt first, InputIt last) {
+  std::vector<value_type> items(first, last);
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const value_type &a, const value_type &b) {
+                     return less_(a, b);
+                   });
+  build_from_sorted_(std::make_move_iterator(items.begin()),
+                     std::make_move_iterator(items.end()), true);
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::insert_sorted(ForwardIt first,
+                                                     ForwardIt last) {
+  size_type inserted = 0;
+  insert_sorted_(first, last, true,
+                 [&inserted](bool linked) { inserted += linked; });
+  return inserted;
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename OutputIt>
+OutputIt BinarySearchTree<T, Compare, Augment>::insert_sorted(ForwardIt first,
+                                                              ForwardIt last,
+                                                              OutputIt out) {
+  insert_sorted_(first, last, true, [&out](bool linked) { *out++ = linked; });
+  return out;
+}
+
+// A run of k elements is merged into a tree of n one of two ways. Short
+// runs go through finger_insert_; once k is a sizable fraction of n, the
+// O(n + k) merge_rebuild_ beats k rebalancing walks to the root. The
+// range is checked first, so an unsorted one throws std::invalid_argument
+// before anything is inserted. Past that point finger_insert_ gives the
+// basic guarantee and merge_rebuild_ the strong one.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename Report>
+void BinarySearchTree<T, Compare, Augment>::insert_sorted_(ForwardIt first,
+                                                           ForwardIt last,
+                                                           bool unique,
+                                                           Report report) {
+  size_type count = 0;
+  for (ForwardIt prev = first, it = first; it != last; prev = it++) {
+    if (it != first && less_(*it, *prev)) {
+      throw std::invalid_argument("range is not sorted");
+    }
+    count++;
+  }
+  if (count * rebuild_ratio_ >= size()) {
+    merge_rebuild_(first, last, count, unique, report);
+  } else {
+    finger_insert_(first, last, unique, report);
   }
-  S21Stack<node *> stack_another_tree;
-  S21Stack<node *> stack_this_tree;
-  stack_another_tree.push(nullptr);
-  stack_this_tree.push(nullptr);
-  node *current_another_tree = another.root_;
-  node *current_cp = new node;
-  root_ = current_cp;
-  info_cp(current_cp, current_another_tree);
-  do {
-    if (current_another_tree != nullptr) {
-      if (current_another_tree->right) {
-        stack_another_tree.push(current_another_tree->right);
+}
+
+// Finger insertion: the next element belongs after the node the previous
+// one landed on. The search climbs from that node only to the lowest
+// ancestor whose subtree still bounds the element and descends from
+// there, which costs O(log d) comparisons for an element d positions away
+// instead of O(log n), on a path that is still in cache. Each element is
+// reported as soon as it is placed, so if a construction throws, the
+// elements before it stay inserted and out holds exactly their results.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename Report>
+void BinarySearchTree<T, Compare, Augment>::finger_insert_(ForwardIt first,
+                                                           ForwardIt last,
+                                                           bool unique,
+                                                           Report report) {
+  node *finger = nullptr;
+  for (; first != last; ++first) {
+    const value_type &val = *first;
+    node *cur = root_;
+    if (finger) {
+      cur = finger;
+      while (cur->parent &&
+             !(cur == cur->parent->left && less_(val, cur->parent->info))) {
+        cur = cur->parent;
       }
-      info_cp(current_cp, current_another_tree);
-      if (current_another_tree->left) {
-        node *cp_node_left = new node;
-        info_cp(cp_node_left, current_another_tree->left);
-        current_cp->left = cp_node_left;
+    }
+    node *parent = nullptr;
+    node *candidate = nullptr;
+    int side = left_side;
+    while (cur) {
+      parent = cur;
+      if (less_(val, cur->info)) {
+        side = left_side;
+        cur = cur->left;
       } else {
-        current_cp->left = nullptr;
+        candidate = cur;
+        side = right_side;
+        cur = cur->right;
       }
+    }
+    if (unique && candidate && !less_(candidate->info, val)) {
+      finger = candidate;
+      report(false);
+      continue;
+    }
+    finger = construct_node_(*first);
+    link_node_(parent, side, finger);
+    report(true);
+  }
+}
 
-      if (current_another_tree->right) {
-        node *cp_node_right = new node;
-        info_cp(cp_node_right, current_another_tree->right);
-        current_cp->right = cp_node_right;
-        stack_this_tree.push(current_cp->right);
-      } else {
-        current_cp->right = nullptr;
+// Merges the run with the in-order sequence of existing nodes and relinks
+// the result into a perfectly balanced tree. Existing nodes are relinked,
+// never copied, and the tree is left untouched until every new node has
+// been constructed; results are buffered until then, so nothing is
+// reported for a run that throws.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt, typename Report>
+void BinarySearchTree<T, Compare, Augment>::merge_rebuild_(ForwardIt first,
+                                                           ForwardIt last,
+                                                           size_type count,
+                                                           bool unique,
+                                                           Report report) {
+  std::vector<node *> nodes;
+  nodes.reserve(size() + count);
+  std::vector<bool> inserted;
+  inserted.reserve(count);
+  bool created = false;
+  node *cur = leftmost_;
+  try {
+    for (; first != last; ++first) {
+      const value_type &val = *first;
+      while (cur && !less_(val, cur->info)) {
+        nodes.push_back(cur);
+        cur = next_node_(cur);
+      }
+      node *prev = nodes.empty() ? nullptr : nodes.back();
+      bool linked = !unique || !prev || less_(prev->info, val);
+      inserted.push_back(linked);
+      if (linked) {
+        nodes.push_back(construct_node_(*first));
+        created = true;
+      }
+    }
+  } catch (...) {
+    for (node *n : nodes) {
+      if (n->parent == nullptr && n != root_) {
+        destroy_node_(n);  // constructed here, not linked yet
       }
+    }
+    throw;
+  }
+  if (created) {
+    for (; cur; cur = next_node_(cur)) {
+      nodes.push_back(cur);
+    }
+    root_ = link_balanced_(nodes.data(), nodes.size());
+    root_->parent = nullptr;
+    leftmost_ = nodes.front();
+    rightmost_ = nodes.back();
+  }
+  for (bool linked : inserted) {
+    report(linked);
+  }
+}
 
-      current_cp = current_cp->left;
-      current_another_tree = current_another_tree->left;
-    } else {
-      current_another_tree = stack_another_tree.top();
-      current_cp = stack_this_tree.top();
-      stack_another_tree.pop();
-      stack_this_tree.pop();
+// Links nodes[0, count) into a perfectly balanced subtree in that order
+// and returns its root.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::link_balanced_(
+    node *const *nodes, size_type count) noexcept {
+  if (count == 0) {
+    return nullptr;
+  }
+  size_type left_count = count / 2;
+  node *middle = nodes[left_count];
+  middle->left = link_balanced_(nodes, left_count);
+  middle->right = link_balanced_(nodes + left_count + 1,
+                                 count - left_count - 1);
+  if (middle->left) {
+    middle->left->parent = middle;
+  }
+  if (middle->right) {
+    middle->right->parent = middle;
+  }
+  update_node_(middle);
+  return middle;
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt>
+void BinarySearchTree<T, Compare, Augment>::build_from_sorted_(ForwardIt first,
+                                                               ForwardIt last,
+                                                               bool unique) {
+  size_type count = 0;
+  for (ForwardIt prev = first, it = first; it != last; prev = it++) {
+    if (it == first) {
+      count++;
+    } else if (less_(*it, *prev)) {
+      throw std::invalid_argument("range is not sorted");
+    } else if (!unique || less_(*prev, *it)) {
+      count++;
     }
-  } while (!stack_another_tree.empty());
+  }
+  clear();
+  root_ = build_balanced_(first, last, count, unique);
+  leftmost_ = leftmost_of_(root_);
+  rightmost_ = rightmost_of_(root_);
+}
+
+// Builds the subtree for the next count elements of the range, advancing
+// it past them. The left half is built first, so nodes are created in
+// order and the input is read exactly once.
+template <typename T, typename Compare, typename Augment>
+template <typename ForwardIt>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::build_balanced_(ForwardIt &it,
+                                                       ForwardIt last,
+                                                       size_type count,
+                                                       bool unique) {
+  if (count == 0) {
+    return nullptr;
+  }
+  size_type left_count = count / 2;
+  node *left = build_balanced_(it, last, left_count, unique);
+  node *middle = nullptr;
+  try {
+    middle = construct_node_(*it);
+  } catch (...) {
+    destroy_subtree_(left);
+    throw;
+  }
+  ++it;
+  while (unique && it != last && !less_(middle->info, *it)) {
+    ++it;
+  }
+  node *right = nullptr;
+  try {
+    right = build_balanced_(it, last, count - left_count - 1, unique);
+  } catch (...) {
+    destroy_subtree_(left);
+    destroy_node_(middle);
+    throw;
+  }
+  middle->left = left;
+  middle->right = right;
+  if (left) {
+    left->parent = middle;
+  }
+  if (right) {
+    right->parent = middle;
+  }
+  update_node_(middle);
+  return middle;
+}
+
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::BinarySearchTree(
+    BinarySearchTree const &another) {
+  root_ = nullptr;
+  *this = another;
+}
+
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment> &
+BinarySearchTree<T, Compare, Augment>::operator=(
+    BinarySearchTree const &another) {
+  assign(another);
   return *this;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::empty() const noexcept {
+// The copy takes its nodes from a single arena block sized by
+// another.size(), keeps the shape of another and needs no auxiliary
+// memory. Subtrees too large to copy on one thread are split between up
+// to threads workers (threads == 0 uses every hardware thread).
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::assign(
+    const BinarySearchTree &another, unsigned threads) {
+  if (this == &another) {
+    return;
+  }
+  clear();
+  comp_ = another.comp_;
+  if (another.root_ == nullptr) {
+    return;
+  }
+  if (!arena_) {
+    arena_ = std::make_shared<arena_type>();
+  }
+  size_type count = another.size();
+  void *block = arena_->allocate_block(count);
+  try {
+    root_ = copy_subtree_(another.root_, nullptr, block, 0,
+                          count >= 2 * parallel_grain ? forks_for_(threads)
+                                                      : 0);
+  } catch (...) {
+    for (size_type i = 0; i < count; i++) {
+      arena_->deallocate(arena_type::slot_in_block(block, i));
+    }
+    throw;
+  }
+  leftmost_ = leftmost_of_(root_);
+  rightmost_ = rightmost_of_(root_);
+}
+
+template <typename T, typename Compare, typename Augment>
+bool BinarySearchTree<T, Compare, Augment>::empty() const noexcept {
   if (root_ == nullptr) {
     return true;
   }
   return false;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::size_type BinarySearchTree<T>::size()
-    const noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::size() const noexcept {
   if (root_ == nullptr) {
     return 0;
   }
   return root_->left_descendents_amount + root_->right_descendents_amount + 1;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::size_type BinarySearchTree<T>::max_size()
-    const noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::max_size() const noexcept {
   return max_long;
 }
 
-template <typename T>
-BinarySearchTree<T> &BinarySearchTree<T>::operator=(
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment> &
+BinarySearchTree<T, Compare, Augment>::operator=(
     BinarySearchTree &&another) noexcept {
   clear();
+  comp_ = another.comp_;
+  arena_ = std::move(another.arena_);
   root_ = another.root_;
+  leftmost_ = another.leftmost_;
+  rightmost_ = another.rightmost_;
   another.root_ = nullptr;
+  another.leftmost_ = nullptr;
+  another.rightmost_ = nullptr;
   return *this;
 }
 
-template <typename T>
-void BinarySearchTree<T>::clear() {
-  S21Stack<node *> st;
-  st.push(root_);
-  node *cur = root_;
-  while (!st.empty()) {
-    if (cur) {
-      if (cur->right) {
-        st.push(cur->right);
-      }
-      node *next = cur->left;
-      delete cur;
-      cur = next;
-    } else {
-      cur = st.top();
-      st.pop();
+// With a private arena the whole slab is handed back at once; nodes are
+// only visited when their value or summary has a destructor to run. Nodes
+// in a shared arena are returned to its free list one by one.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::clear() {
+  if (arena_ && arena_.use_count() == 1) {
+    if (!std::is_trivially_destructible<node>::value) {
+      destroy_subtree_(root_);
     }
+    arena_->release();
+  } else if (arena_) {
+    destroy_subtree_(root_);
   }
   root_ = nullptr;
-  custom_compare_ = nullptr;
-}
-
-template <typename T>
-typename BinarySearchTree<T>::Iterator BinarySearchTree<T>::begin()
-    const noexcept {
-  Iterator it(root_, 0);
-  return it;
-}
-
-template <typename T>
-typename BinarySearchTree<T>::Iterator BinarySearchTree<T>::end()
-    const noexcept {
-  Iterator it(root_);
-  return it;
+  leftmost_ = nullptr;
+  rightmost_ = nullptr;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::node *
-BinarySearchTree<T>::ConstIterator::find_node_by_index_(long index) noexcept {
-  if (index < 0 || index > (long)root_->left_descendents_amount +
-                               (long)root_->right_descendents_amount) {
-    cur_ = nullptr;
-    cur_index_ = -1;
-    return cur_;
+// Post-order walk over parent pointers, so no auxiliary stack is needed.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::destroy_subtree_(
+    node *root) noexcept {
+  node *cur = root;
+  if (cur && cur->parent) {
+    replace_child_(cur->parent, cur, nullptr);
+    cur->parent = nullptr;
   }
-  index++;
-  unsigned long cur_index = root_->left_descendents_amount + 1;
-  unsigned long last_index_before_right = 0;
-  node *cur = root_;
-  while (index != (long)cur_index) {
-    if ((long)cur_index > index) {
+  while (cur) {
+    if (cur->left) {
       cur = cur->left;
-      cur_index = cur->left_descendents_amount + last_index_before_right + 1;
-    }
-    if ((long)cur_index < index) {
-      last_index_before_right = cur_index;
+    } else if (cur->right) {
       cur = cur->right;
-      cur_index = last_index_before_right + cur->left_descendents_amount + 1;
+    } else {
+      node *parent = cur->parent;
+      if (parent && parent->left == cur) {
+        parent->left = nullptr;
+      } else if (parent) {
+        parent->right = nullptr;
+      }
+      destroy_node_(cur);
+      cur = parent;
     }
   }
-  return cur;
 }
 
-template <typename T>
-BinarySearchTree<T>::ConstIterator::ConstIterator(node *root) noexcept {
-  root_ = root;
-  cur_ = nullptr;
-  cur_index_ = -1;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::Iterator
+BinarySearchTree<T, Compare, Augment>::begin() const noexcept {
+  Iterator it(this, leftmost_);
+  return it;
 }
 
-template <typename T>
-BinarySearchTree<T>::ConstIterator::ConstIterator(node *root, int index) {
-  root_ = root;
-  if (root_ == nullptr) {
-    cur_ = nullptr;
-  } else {
-    cur_ = find_node_by_index_(index);
-  }
-  cur_index_ = index;
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::Iterator
+BinarySearchTree<T, Compare, Augment>::end() const noexcept {
+  Iterator it(this);
+  return it;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::ConstIterator::tree_size_()
+    const noexcept {
+  return BinarySearchTree<T, Compare, Augment>::subtree_size_(tree_root_());
+}
+
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::ConstIterator::ConstIterator(
+    const BinarySearchTree *tree) noexcept {
+  tree_ = tree;
+  cur_ = nullptr;
 }
 
-template <typename T>
-BinarySearchTree<T>::ConstIterator::ConstIterator(
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::ConstIterator::ConstIterator(
     const ConstIterator &another) noexcept {
-  root_ = another.root_;
+  tree_ = another.tree_;
   cur_ = another.cur_;
-  cur_index_ = another.cur_index_;
 }
 
-template <typename T>
-BinarySearchTree<T>::ConstIterator::ConstIterator(
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::ConstIterator::ConstIterator(
     ConstIterator &&another) noexcept {
-  root_ = another.root_;
-  another.root_ = nullptr;
+  tree_ = another.tree_;
+  another.tree_ = nullptr;
   cur_ = another.cur_;
   another.cur_ = nullptr;
-  cur_index_ = another.cur_index_;
-  another.cur_index_ = 0;
 }
 
-template <typename T>
-BinarySearchTree<T>::ConstIterator::ConstIterator(node *root, node *cur,
-                                                  long cur_index) noexcept {
-  root_ = root;
+template <typename T, typename Compare, typename Augment>
+BinarySearchTree<T, Compare, Augment>::ConstIterator::ConstIterator(
+    const BinarySearchTree *tree, node *cur) noexcept {
+  tree_ = tree;
   cur_ = cur;
-  cur_index_ = cur_index;
 }
 
-template <typename T>
-long BinarySearchTree<T>::find_index_by_value_(value_type &a) const noexcept {
+template <typename T, typename Compare, typename Augment>
+long BinarySearchTree<T, Compare, Augment>::find_index_by_value_(
+    const value_type &a) const noexcept {
   node *cur = root_;
-  long cur_index = cur->left_descendents_amount + 1;
-  long last_index_before_right = 0;
+  long passed = 0;
   int comp = 0;
-  while ((comp = compare_(a, cur->info)) != 0) {
-    if (comp == 1) {
-      last_index_before_right = cur_index;
+  while (cur && (comp = compare_(a, cur->info)) != 0) {
+    if (comp == bigger) {
+      passed += cur->left_descendents_amount + 1;
       cur = cur->right;
-      cur_index += cur->left_descendents_amount + 1;
     } else {
       cur = cur->left;
-      cur_index = cur->left_descendents_amount + 1 + last_index_before_right;
     }
   }
   if (cur) {
-    return --cur_index;
+    return passed + cur->left_descendents_amount;
   }
   return -1;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator=(
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator=(
     const ConstIterator &another) noexcept {
   cur_ = another.cur_;
-  root_ = another.root_;
-  cur_index_ = another.cur_index_;
+  tree_ = another.tree_;
   return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator=(
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator=(
     ConstIterator &&another) noexcept {
   cur_ = another.cur_;
-  root_ = another.root_;
-  cur_index_ = another.cur_index_;
+  tree_ = another.tree_;
   another.cur_ = nullptr;
-  another.root_ = nullptr;
-  another.cur_index_ = -1;
+  another.tree_ = nullptr;
   return *this;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::ConstIterator::operator==(
+template <typename T, typename Compare, typename Augment>
+bool BinarySearchTree<T, Compare, Augment>::ConstIterator::operator==(
     const ConstIterator &another) const {
-  if (root_ != another.root_) {
-    return false;
-  }
-  if (cur_ != another.cur_) {
-    return false;
-  }
-  if (cur_index_ != another.cur_index_) {
-    return false;
-  }
-  return true;
+  return cur_ == another.cur_;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::ConstIterator::operator!=(
+// Nodes never move while they are in a tree, so the node alone identifies
+// the position; every end() is the null node.
+template <typename T, typename Compare, typename Augment>
+bool BinarySearchTree<T, Compare, Augment>::ConstIterator::operator!=(
     const ConstIterator &another) const {
-  if (root_ == another.root_ && cur_ == another.cur_) {
-    return false;
-  }
-  return true;
+  return !(*this == another);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator++() noexcept {
-  cur_ = find_node_by_index_(++cur_index_);
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator++() noexcept {
   if (cur_ == nullptr) {
-    cur_index_ = -1;
+    cur_ = BinarySearchTree<T, Compare, Augment>::leftmost_of_(tree_root_());
+    return *this;
   }
+  cur_ = BinarySearchTree<T, Compare, Augment>::next_node_(cur_);
   return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator
-BinarySearchTree<T>::ConstIterator::operator++(int) noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator++(int) noexcept {
   ConstIterator it = *this;
   ++(*this);
   return it;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator--() noexcept {
-  cur_ = find_node_by_index_(--cur_index_);
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator--() noexcept {
   if (cur_ == nullptr) {
-    cur_index_ = -1;
+    cur_ = BinarySearchTree<T, Compare, Augment>::rightmost_of_(tree_root_());
+    return *this;
   }
+  cur_ = BinarySearchTree<T, Compare, Augment>::prev_node_(cur_);
   return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator
-BinarySearchTree<T>::ConstIterator::operator--(int) noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator--(int) noexcept {
   ConstIterator it = *this;
   --(*this);
   return it;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator-(int n) noexcept {
-  cur_index_ -= n;
-  cur_ = find_node_by_index_(cur_index_);
-  return *this;
+// Position in the in-order sequence, counted up the parent pointers in
+// O(log n) so that it stays right after updates elsewhere in the tree;
+// end() sits at size().
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator::difference_type
+BinarySearchTree<T, Compare, Augment>::ConstIterator::position_()
+    const noexcept {
+  return cur_ ? tree_->find_index_by_node_(cur_)
+              : static_cast<difference_type>(tree_size_());
 }
 
-template <typename T>
-typename BinarySearchTree<T>::ConstIterator &
-BinarySearchTree<T>::ConstIterator::operator+(int n) noexcept {
-  cur_index_ += n;
-  cur_ = find_node_by_index_(cur_index_);
+// Jumps select the target by descendant counters from the root, so they
+// cost O(log n) whatever the distance. Jumping outside [begin, end] gives
+// end().
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator+=(
+    difference_type n) noexcept {
+  difference_type target = position_() + n;
+  if (target < 0 || target >= static_cast<difference_type>(tree_size_())) {
+    cur_ = nullptr;
+  } else {
+    cur_ = tree_->node_at_(static_cast<size_type>(target));
+  }
   return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::value_type *
-BinarySearchTree<T>::ConstIterator::operator->() noexcept {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator-=(
+    difference_type n) noexcept {
+  return *this += -n;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator+(
+    difference_type n) const noexcept {
+  ConstIterator it(*this);
+  it += n;
+  return it;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator-(
+    difference_type n) const noexcept {
+  ConstIterator it(*this);
+  it -= n;
+  return it;
+}
+
+// Both positions are counted up the parent pointers, O(log n).
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::ConstIterator::difference_type
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator-(
+    const ConstIterator &another) const noexcept {
+  return position_() - another.position_();
+}
+
+template <typename T, typename Compare, typename Augment>
+const typename BinarySearchTree<T, Compare, Augment>::value_type *
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator->()
+    const noexcept {
   if (cur_ == nullptr) {
     return nullptr;
   }
-  const value_type *ptr = &(cur_->info);
-  return ptr;
+  return &(cur_->info);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::value_type &
-BinarySearchTree<T>::ConstIterator::operator*() {
+template <typename T, typename Compare, typename Augment>
+const typename BinarySearchTree<T, Compare, Augment>::value_type &
+BinarySearchTree<T, Compare, Augment>::ConstIterator::operator*() const {
   if (cur_ == nullptr) {
     throw std::out_of_range("Tried to dereference pointer to null");
   }
   return cur_->info;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::value_type *
-BinarySearchTree<T>::Iterator::operator->() {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::value_type *
+BinarySearchTree<T, Compare, Augment>::Iterator::operator->() {
   return &(this->cur_->info);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::value_type &
-BinarySearchTree<T>::Iterator::operator*() {
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::value_type &
+BinarySearchTree<T, Compare, Augment>::Iterator::operator*() {
   return this->cur_->info;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::node *BinarySearchTree<T>::find_node_by_value_(
-    typename BinarySearchTree<T>::value_type &val) const noexcept {
-  if (root_ == nullptr) {
-    return nullptr;
-  }
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::node *
+BinarySearchTree<T, Compare, Augment>::find_node_by_value_(
+    const value_type &val) const noexcept {
   node *cur = root_;
-  while (int comp = compare_(cur->info, val) != 0) {
-    if (comp == 1) {
+  node *candidate = nullptr;
+  while (cur) {
+    if (less_(cur->info, val)) {
       cur = cur->right;
-    } else if (comp == -1) {
+    } else {
+      candidate = cur;
       cur = cur->left;
     }
-    if (cur == nullptr) {
-      break;
-    }
   }
-  return cur;
+  if (candidate && !less_(val, candidate->info)) {
+    return candidate;
+  }
+  return nullptr;
 }
 
-template <typename T>
-void BinarySearchTree<T>::erase(value_type value) {
-  bool deleting_root = false;
-  BinarySearchTree<T> descendets_of_deleted(find_node_by_value_(value),
-                                            custom_compare_);
-  std::pair<node *, int> parent_of_erased = define_place_for_new_node_(value);
-  if (parent_of_erased.first == nullptr) {
-    deleting_root = true;
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::erase(const value_type &value) {
+  node *erased = find_node_by_value_(value);
+  if (erased == nullptr) {
+    return;
   }
-  node *cur = root_;
-  int comp = 0;
-  if (!deleting_root) {
-    while ((comp = compare_(value, cur->info)) != 0) {
-      if (comp == 1) {
-        cur->right_descendents_amount--;
-        cur = cur->right;
-      } else if (comp == -1) {
-        cur->left_descendents_amount--;
-        cur = cur->left;
-      }
-    }
-    if (parent_of_erased.second == -1) {
-      parent_of_erased.first->left = nullptr;
-    } else if (parent_of_erased.second == 1) {
-      parent_of_erased.first->right = nullptr;
-    }
-  } else {
-    root_ = nullptr;
+  unlink_node_(erased);
+  destroy_node_(erased);
+}
+
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::erase(iterator to_delete) {
+  if (to_delete.cur_ == nullptr) {
+    return;
   }
-  for (auto it = descendets_of_deleted.begin();
-       it != descendets_of_deleted.end(); it++) {
-    if (it.cur_ == descendets_of_deleted.root_) {
-      continue;
-    }
-    if (deleting_root) {
-      insert(construct_node_(it.cur_->info), 1);
-    } else {
-      insert_descendent_of_deleted_(*it);
-    }
+  unlink_node_(to_delete.cur_);
+  destroy_node_(to_delete.cur_);
+}
+
+// Cuts the elements with in-order indexes [from, to) out as one subtree
+// and joins what is left, so the tree is rebalanced in O(log n) however
+// many elements go; only their destruction is linear.
+template <typename T, typename Compare, typename Augment>
+void BinarySearchTree<T, Compare, Augment>::erase_positions_(
+    size_type from, size_type to) noexcept {
+  if (to > size()) {
+    to = size();
+  }
+  if (from >= to) {
+    return;
+  }
+  node *left = nullptr;
+  node *rest = nullptr;
+  node *erased = nullptr;
+  node *right = nullptr;
+  split_at_(root_, from, left, rest);
+  split_at_(rest, to - from, erased, right);
+  root_ = join2_(left, right);
+  if (root_) {
+    root_->parent = nullptr;
+  }
+  leftmost_ = leftmost_of_(root_);
+  rightmost_ = rightmost_of_(root_);
+  erased->parent = nullptr;
+  destroy_subtree_(erased);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::erase(const ConstIterator &first,
+                                             const ConstIterator &last) {
+  size_type from = first.cur_ ? find_index_by_node_(first.cur_) : size();
+  size_type to = last.cur_ ? find_index_by_node_(last.cur_) : size();
+  erase_positions_(from, to);
+  return nth(from);
+}
+
+// Erases the elements in [low, high) and returns how many there were.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::size_type
+BinarySearchTree<T, Compare, Augment>::erase_range(const value_type &low,
+                                                   const value_type &high) {
+  size_type from = rank(low);
+  size_type to = rank(high);
+  if (from >= to) {
+    return 0;
   }
+  erase_positions_(from, to);
+  return to - from;
+}
+
+// Two descents locate the range by rank; the elements are then visited
+// through successor links, with no comparison against the upper bound.
+template <typename T, typename Compare, typename Augment>
+template <typename Fn>
+void BinarySearchTree<T, Compare, Augment>::for_each_at_(size_type from,
+                                                         size_type to,
+                                                         Fn &fn) const {
+  node *cur = from < to ? node_at_(from) : nullptr;
+  for (size_type i = from; i < to && cur; i++) {
+    const value_type &value = cur->info;
+    fn(value);
+    cur = next_node_(cur);
+  }
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::summary_type
+BinarySearchTree<T, Compare, Augment>::aggregate_at_(size_type from,
+                                                     size_type to) const {
+  static_assert(augmented_, "aggregate needs an augmentation policy");
+  return summary_between_(root_, from, to);
+}
+
+// Combined summary of the elements in [low, high), in O(log n).
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::summary_type
+BinarySearchTree<T, Compare, Augment>::aggregate(
+    const value_type &low, const value_type &high) const {
+  return aggregate_at_(rank(low), rank(high));
+}
+
+// Calls fn on every element in [low, high), in order.
+template <typename T, typename Compare, typename Augment>
+template <typename Fn>
+void BinarySearchTree<T, Compare, Augment>::for_each_in_range(
+    const value_type &low, const value_type &high, Fn fn) const {
+  for_each_at_(rank(low), rank(high), fn);
 }
 
-template <typename T>
-void BinarySearchTree<T>::erase(iterator to_delete) {
-  erase(*to_delete);
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert(const value_type &val,
+                                              int insertion) {
+  return insert_unique_(val, insertion);
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool>
-BinarySearchTree<T>::insert(value_type &val, int insertion) {
-  node *new_node = construct_node_(val);
-  return insert_new_node_(new_node, insertion);
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert(value_type &&val,
+                                              int insertion) {
+  return insert_unique_(std::move(val), insertion);
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool>
-BinarySearchTree<T>::insert(value_type val, int insertion) {
-  node *new_node = construct_node_(val);
-  return insert_new_node_(new_node, insertion);
+// A finished value_type is looked up before any node exists; anything
+// else has to be constructed first to learn where it goes, and its node
+// is dropped again if an equal element is already present.
+template <typename T, typename Compare, typename Augment>
+template <typename... Args>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::emplace(Args &&...args) {
+  if constexpr (sizeof...(Args) == 1 &&
+                (std::is_same<std::decay_t<Args>, value_type>::value && ...)) {
+    return insert_unique_(std::forward<Args>(args)...);
+  } else {
+    return insert_new_node_(emplace_node_(std::forward<Args>(args)...), 1);
+  }
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool>
-BinarySearchTree<T>::insert(node *val, int insertion) {
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert(node *val, int insertion) {
   return insert_new_node_(val, insertion);
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool>
-BinarySearchTree<T>::insert_new_node_(node *new_node, int insertion) {
-  if (root_ == nullptr) {
-    root_ = new_node;
-    Iterator it(root_, 0);
-    return std::make_pair(it, true);
+// The node is only built once the descent has shown that val is absent,
+// so a duplicate costs neither an allocation nor a copy.
+template <typename T, typename Compare, typename Augment>
+template <typename Arg>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert_unique_(Arg &&val,
+                                                      int insertion) {
+  slot_ slot = find_slot_(val);
+  if (slot.found()) {
+    return std::make_pair(iterator_at_(slot), false);
+  }
+  if (insertion == 0) {
+    return std::make_pair(end(), false);
+  }
+  node *new_node = construct_node_(std::forward<Arg>(val));
+  return std::make_pair(link_at_(slot, new_node), true);
+}
+
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::Iterator, bool>
+BinarySearchTree<T, Compare, Augment>::insert_new_node_(node *new_node,
+                                                        int insertion) {
+  slot_ slot = find_slot_(new_node->info);
+  if (slot.found() || insertion == 0) {
+    destroy_node_(new_node);
+    return std::make_pair(slot.found() ? iterator_at_(slot) : end(), false);
   }
-  std::pair<node *, int> place =
-      define_place_for_new_node_(new_node->info, insertion);
-  if (place.second == 1 && !place.first->right) {
-    place.first->right = new_node;
-    Iterator it(root_, new_node, find_index_by_value_(new_node->info));
-    return std::make_pair(it, true);
+  return std::make_pair(link_at_(slot, new_node), true);
+}
+
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::node *, int>
+BinarySearchTree<T, Compare, Augment>::define_place_for_new_node_(
+    const value_type &val) {
+  slot_ slot = find_slot_(val);
+  return std::make_pair(slot.parent, slot.side);
+}
+
+// One comparison per level plus one at the end: the descent only asks
+// whether the probe is ordered before the node, remembering the last node
+// it was not, which is the only possible equal one.
+template <typename T, typename Compare, typename Augment>
+template <typename Probe, typename Less>
+typename BinarySearchTree<T, Compare, Augment>::slot_
+BinarySearchTree<T, Compare, Augment>::find_slot_(const Probe &probe,
+                                                  Less less) const noexcept {
+  slot_ slot;
+  node *cur = root_;
+  node *candidate = nullptr;
+  while (cur) {
+    slot.parent = cur;
+    if (less(probe, cur->info)) {
+      slot.side = left_side;
+      cur = cur->left;
+    } else {
+      candidate = cur;
+      slot.side = right_side;
+      cur = cur->right;
+    }
   }
-  if (place.second == -1 && !place.first->left) {
-    place.first->left = new_node;
-    Iterator it(root_, new_node, find_index_by_value_(new_node->info));
-    return std::make_pair(it, true);
+  if (candidate && !less(candidate->info, probe)) {
+    slot.parent = candidate;
+    slot.side = equal;
   }
-  Iterator it(root_, place.first, find_index_by_value_(new_node->info));
-  delete new_node;
-  return std::make_pair(it, false);
+  return slot;
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::slot_
+BinarySearchTree<T, Compare, Augment>::find_slot_(
+    const value_type &val) const noexcept {
+  return find_slot_(val, [this](const value_type &a, const value_type &b) {
+    return less_(a, b);
+  });
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::link_at_(const slot_ &slot,
+                                                node *new_node) noexcept {
+  link_node_(slot.parent, slot.side, new_node);
+  return Iterator(this, new_node);
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::node *, int>
-BinarySearchTree<T>::define_place_for_new_node_(value_type val, int insertion) {
+// Leaf position for val after every element equal to it, as multisets
+// insert.
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::node *, int>
+BinarySearchTree<T, Compare, Augment>::place_after_equals_(
+    const value_type &val) const noexcept {
   node *current = root_;
   node *prev = nullptr;
   int side = 0;
-  int comp = 0;
-  while (current && (comp = compare_(current->info, val)) != 0) {
-    if (comp == -1) {
-      current->right_descendents_amount += insertion;
-      prev = current;
+  while (current) {
+    prev = current;
+    if (!less_(val, current->info)) {
       current = current->right;
       side = right_side;
-    } else if (comp == 1) {
-      current->left_descendents_amount += insertion;
-      prev = current;
+    } else {
       current = current->left;
       side = left_side;
     }
@@ -731,5 +2603,112 @@ BinarySearchTree<T>::define_place_for_new_node_(value_type val, int insertion) {
   return std::make_pair(prev, side);
 }
 
+// Checks that val belongs right before hint: between its in-order
+// predecessor and hint itself (end() has the cached rightmost node as its
+// predecessor). That takes at most two comparisons, and the new node then
+// hangs off whichever of the two neighbours has a free slot on the facing
+// side. Returns false when the hint is wrong.
+template <typename T, typename Compare, typename Augment>
+bool BinarySearchTree<T, Compare, Augment>::place_by_hint_(
+    const ConstIterator &hint, const value_type &val, bool unique,
+    std::pair<node *, int> &place) const noexcept {
+  node *next = node_of_(hint);
+  node *prev = next ? prev_node_(next) : rightmost_;
+  if (unique) {
+    if (prev && !less_(prev->info, val)) {
+      if (less_(val, prev->info)) {
+        return false;
+      }
+      place = std::make_pair(prev, equal);
+      return true;
+    }
+    if (next && !less_(val, next->info)) {
+      if (less_(next->info, val)) {
+        return false;
+      }
+      place = std::make_pair(next, equal);
+      return true;
+    }
+  } else if ((prev && less_(val, prev->info)) ||
+             (next && less_(next->info, val))) {
+    return false;
+  }
+  if (next && next->left == nullptr) {
+    place = std::make_pair(next, left_side);
+  } else {
+    place = std::make_pair(prev, right_side);
+  }
+  return true;
+}
+
+// A correct hint replaces the descent from the root; a wrong one costs two
+// extra comparisons before the usual descent. With unique, a place whose
+// side is equal is the element val duplicates.
+template <typename T, typename Compare, typename Augment>
+std::pair<typename BinarySearchTree<T, Compare, Augment>::node *, int>
+BinarySearchTree<T, Compare, Augment>::hint_place_(const ConstIterator &hint,
+                                                   const value_type &val,
+                                                   bool unique) {
+  std::pair<node *, int> place;
+  if (!place_by_hint_(hint, val, unique, place)) {
+    place = unique ? define_place_for_new_node_(val)
+                   : place_after_equals_(val);
+  }
+  return place;
+}
+
+// The value is placed first and copied or moved into a node only when it
+// is not a duplicate.
+template <typename T, typename Compare, typename Augment>
+template <typename Arg>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::insert_hint_value_(
+    const ConstIterator &hint, Arg &&val, bool unique) {
+  std::pair<node *, int> place = hint_place_(hint, val, unique);
+  if (unique && place.second == equal && place.first != nullptr) {
+    return Iterator(this, place.first);
+  }
+  node *new_node = construct_node_(std::forward<Arg>(val));
+  link_node_(place.first, place.second, new_node);
+  return Iterator(this, new_node);
+}
+
+// For emplace_hint, whose value only exists once the node is built.
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::insert_hint_node_(
+    const ConstIterator &hint, node *new_node, bool unique) {
+  std::pair<node *, int> place = hint_place_(hint, new_node->info, unique);
+  if (unique && place.second == equal && place.first != nullptr) {
+    destroy_node_(new_node);
+    return Iterator(this, place.first);
+  }
+  link_node_(place.first, place.second, new_node);
+  return Iterator(this, new_node);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::insert(const ConstIterator &hint,
+                                              const value_type &val) {
+  return insert_hint_value_(hint, val, true);
+}
+
+template <typename T, typename Compare, typename Augment>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::insert(const ConstIterator &hint,
+                                              value_type &&val) {
+  return insert_hint_value_(hint, std::move(val), true);
+}
+
+template <typename T, typename Compare, typename Augment>
+template <typename... Args>
+typename BinarySearchTree<T, Compare, Augment>::iterator
+BinarySearchTree<T, Compare, Augment>::emplace_hint(const ConstIterator &hint,
+                                                    Args &&...args) {
+  return insert_hint_node_(hint, emplace_node_(std::forward<Args>(args)...),
+                           true);
+}
+
 }  // namespace s21
-#endif
\ No newline at end of file
+#endif
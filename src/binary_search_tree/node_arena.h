@@ -0,0 +1,144 @@
+#ifndef CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_NODE_ARENA_H_
+#define CPP2_S21_CONTAINERS_2_BINARY_SEARCH_TREE_NODE_ARENA_H_
+
+#include <cstddef>
+
+namespace s21 {
+
+// Slab allocator for tree nodes. Memory is carved out of pages that grow
+// geometrically, freed slots go to an intrusive free list for reuse, and
+// release() hands every page back at once. The arena only manages raw
+// storage: constructing and destroying nodes is the tree's job. It is not
+// thread-safe; trees sharing one arena must be used from one thread.
+template <typename Node>
+class NodeArena {
+ public:
+  using size_type = size_t;
+  static constexpr size_type first_page_capacity = 16;
+  static constexpr size_type max_page_capacity = 4096;
+
+  NodeArena() noexcept = default;
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+  ~NodeArena() { release(); }
+
+  void *allocate();
+  void *allocate_block(size_type count);
+  static void *slot_in_block(void *block, size_type index) noexcept;
+  void deallocate(void *memory) noexcept;
+  void release() noexcept;
+
+  size_type live() const noexcept { return live_; }  // slots handed out
+  size_type capacity() const noexcept {
+    return capacity_;
+  }  // slots owned by all pages
+
+ private:
+  union slot {
+    slot *next;
+    alignas(Node) unsigned char storage[sizeof(Node)];
+  };
+  struct page {
+    page *next;
+    slot *slots;
+  };
+
+  page *pages_ = nullptr;
+  slot *free_list_ = nullptr;
+  slot *bump_ = nullptr;
+  slot *bump_end_ = nullptr;
+  size_type next_page_capacity_ = first_page_capacity;
+  size_type capacity_ = 0;
+  size_type live_ = 0;
+
+  void add_page_(size_type page_capacity);
+};
+
+template <typename Node>
+void *NodeArena<Node>::allocate() {
+  slot *result = nullptr;
+  if (free_list_) {
+    result = free_list_;
+    free_list_ = free_list_->next;
+  } else {
+    if (bump_ == bump_end_) {
+      add_page_(next_page_capacity_);
+      if (next_page_capacity_ < max_page_capacity) {
+        next_page_capacity_ *= 2;
+      }
+    }
+    result = bump_++;
+  }
+  live_++;
+  return result->storage;
+}
+
+// Hands out count adjacent slots on a page of their own; the unused rest
+// of the current page goes to the free list. Slots of a block are given
+// back one by one with deallocate() like any other.
+template <typename Node>
+void *NodeArena<Node>::allocate_block(size_type count) {
+  if (count == 0) {
+    return nullptr;
+  }
+  slot *rest = bump_;
+  slot *rest_end = bump_end_;
+  add_page_(count);
+  for (; rest != rest_end; rest++) {
+    rest->next = free_list_;
+    free_list_ = rest;
+  }
+  slot *block = bump_;
+  bump_ = bump_end_;
+  live_ += count;
+  return block->storage;
+}
+
+template <typename Node>
+void *NodeArena<Node>::slot_in_block(void *block, size_type index) noexcept {
+  return (reinterpret_cast<slot *>(block) + index)->storage;
+}
+
+template <typename Node>
+void NodeArena<Node>::deallocate(void *memory) noexcept {
+  slot *freed = reinterpret_cast<slot *>(memory);
+  freed->next = free_list_;
+  free_list_ = freed;
+  live_--;
+}
+
+template <typename Node>
+void NodeArena<Node>::release() noexcept {
+  while (pages_) {
+    page *next = pages_->next;
+    delete[] pages_->slots;
+    delete pages_;
+    pages_ = next;
+  }
+  free_list_ = nullptr;
+  bump_ = nullptr;
+  bump_end_ = nullptr;
+  next_page_capacity_ = first_page_capacity;
+  capacity_ = 0;
+  live_ = 0;
+}
+
+template <typename Node>
+void NodeArena<Node>::add_page_(size_type page_capacity) {
+  page *new_page = new page;
+  try {
+    new_page->slots = new slot[page_capacity];
+  } catch (...) {
+    delete new_page;
+    throw;
+  }
+  new_page->next = pages_;
+  pages_ = new_page;
+  bump_ = new_page->slots;
+  bump_end_ = bump_ + page_capacity;
+  capacity_ += page_capacity;
+}
+
+}  // namespace s21
+
+#endif
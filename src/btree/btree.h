@@ -0,0 +1,1019 @@
+#ifndef CPP2_S21_CONTAINERS_2_BTREE_BTREE_H_
+#define CPP2_S21_CONTAINERS_2_BTREE_BTREE_H_
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "../binary_search_tree/binary_search_tree.h"
+#include "../binary_search_tree/node_arena.h"
+
+namespace s21 {
+
+// Key extractors: the whole value for sets, the first member for maps.
+struct BTreeIdentity {
+  template <typename V>
+  const V &operator()(const V &value) const noexcept {
+    return value;
+  }
+};
+
+struct BTreeSelectFirst {
+  template <typename P>
+  const typename P::first_type &operator()(const P &value) const noexcept {
+    return value.first;
+  }
+};
+
+// Minimum degree t picked so that a node holds 15 to 63 values in about
+// 512 bytes: a node fills a handful of cache lines and is searched without
+// following any pointer.
+template <typename Value>
+constexpr size_t btree_default_degree() {
+  constexpr size_t by_size = 512 / sizeof(Value) / 2;
+  return by_size < 8 ? 8 : (by_size > 32 ? 32 : by_size);
+}
+
+// B-tree storage engine. Every node stores up to 2t - 1 values in one
+// contiguous array; inner nodes also store their children and the number
+// of values under each child, so order statistics (nth, rank) are answered
+// in a single descent that never reads the children themselves. Insertion
+// splits full nodes and erasure refills minimal ones on the way down, so
+// both are one top-down pass. Any insertion or erasure invalidates every
+// iterator of the tree.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi,
+          size_t Degree = btree_default_degree<Value>()>
+class BTree {
+  static_assert(Degree >= 2, "a B-tree node needs a minimum degree of 2");
+
+ public:
+  class Iterator;
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+  static constexpr size_type max_keys = 2 * Degree - 1;
+  static constexpr size_type min_keys = Degree - 1;
+
+  BTree() noexcept = default;
+  explicit BTree(const Compare &comp) noexcept : comp_(comp) {}
+  BTree(std::initializer_list<value_type> const &items);
+  BTree(const BTree &another);
+  BTree(BTree &&another) noexcept;
+  ~BTree() { clear(); }
+  BTree &operator=(const BTree &another);
+  BTree &operator=(BTree &&another) noexcept;
+
+  Iterator begin() const noexcept;
+  Iterator end() const noexcept { return Iterator(this, nullptr, 0); }
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+  size_type max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(leaf_node);
+  }
+  key_compare key_comp() const { return comp_; }
+
+  std::pair<Iterator, bool> insert(const value_type &value);
+  std::pair<Iterator, bool> insert(value_type &&value);
+  void erase(Iterator pos);
+  size_type erase(const key_type &key);
+  void clear() noexcept;
+  void swap(BTree &another) noexcept;
+
+  Iterator find(const key_type &key) const noexcept;
+  bool contains(const key_type &key) const noexcept;
+  size_type count(const key_type &key) const noexcept;
+  Iterator lower_bound(const key_type &key) const noexcept;
+  Iterator upper_bound(const key_type &key) const noexcept;
+  std::pair<Iterator, Iterator> equal_range(const key_type &key) const noexcept;
+  Iterator nth(size_type index) const noexcept;
+  size_type rank(const key_type &key) const noexcept;
+
+ protected:
+  struct inner_node;
+  struct leaf_node {
+    inner_node *parent = nullptr;
+    unsigned short slot = 0;  // index in parent->children
+    unsigned short count = 0;
+    bool leaf = true;
+    alignas(Value) unsigned char storage[max_keys * sizeof(Value)];
+    Value *values() noexcept {
+      return std::launder(reinterpret_cast<Value *>(storage));
+    }
+  };
+  struct inner_node : leaf_node {
+    leaf_node *children[max_keys + 1];
+    size_type counts[max_keys + 1];  // values under each child
+  };
+  using node = leaf_node;
+
+  node *root_ = nullptr;
+  size_type size_ = 0;
+  Compare comp_ = Compare();
+  std::unique_ptr<NodeArena<leaf_node>> leaves_;
+  std::unique_ptr<NodeArena<inner_node>> inners_;
+
+  bool less_(const key_type &a, const key_type &b) const {
+    return compare_less(comp_, a, b);
+  }
+  const key_type &key_of_(node *n, size_type i) const noexcept {
+    return KeyOfValue()(n->values()[i]);
+  }
+  static inner_node *inner_(node *n) noexcept {
+    return static_cast<inner_node *>(n);
+  }
+  size_type lower_index_(node *n, const key_type &key) const noexcept;
+  size_type upper_index_(node *n, const key_type &key) const noexcept;
+  static size_type total_(node *n) noexcept;
+  static void set_child_(inner_node *parent, size_type i, node *child,
+                         size_type count) noexcept;
+  static void move_value_(Value *from, Value *to) noexcept;
+  static void shift_right_(node *n, size_type from) noexcept;
+  static void shift_left_(node *n, size_type from) noexcept;
+
+  node *new_leaf_();
+  inner_node *new_inner_();
+  void free_node_(node *n) noexcept;
+  void destroy_(node *n) noexcept;
+  node *clone_(node *source, inner_node *parent, size_type slot);
+
+  template <typename Arg>
+  std::pair<Iterator, bool> insert_(Arg &&value);
+  void split_child_(inner_node *parent, size_type i);
+  Value remove_at_(node *n, size_type index);
+  void rotate_from_left_(inner_node *parent, size_type i) noexcept;
+  void rotate_from_right_(inner_node *parent, size_type i) noexcept;
+  void merge_children_(inner_node *parent, size_type i) noexcept;
+  size_type index_of_(const Iterator &it) const noexcept;
+};
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+class BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Value *;
+  using reference = Value &;
+
+  Iterator() noexcept = default;
+  reference operator*() const noexcept { return node_->values()[pos_]; }
+  pointer operator->() const noexcept { return &node_->values()[pos_]; }
+  Iterator &operator++() noexcept;
+  Iterator operator++(int) noexcept {
+    Iterator old = *this;
+    ++*this;
+    return old;
+  }
+  Iterator &operator--() noexcept;
+  Iterator operator--(int) noexcept {
+    Iterator old = *this;
+    --*this;
+    return old;
+  }
+  bool operator==(const Iterator &another) const noexcept {
+    return node_ == another.node_ && pos_ == another.pos_;
+  }
+  bool operator!=(const Iterator &another) const noexcept {
+    return !(*this == another);
+  }
+
+ private:
+  friend class BTree;
+  Iterator(const BTree *tree, node *n, size_type pos) noexcept
+      : tree_(tree), node_(n), pos_(pos) {}
+  const BTree *tree_ = nullptr;
+  node *node_ = nullptr;  // nullptr for end()
+  size_type pos_ = 0;
+};
+
+// Within a node the next value is either the first value of the next
+// child's leftmost leaf or, at the end of a leaf, the separator of the
+// nearest ancestor still having values to the right.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator &
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator::operator++()
+    noexcept {
+  if (node_ == nullptr) {
+    *this = tree_->begin();
+    return *this;
+  }
+  if (!node_->leaf) {
+    node_ = inner_(node_)->children[pos_ + 1];
+    while (!node_->leaf) {
+      node_ = inner_(node_)->children[0];
+    }
+    pos_ = 0;
+    return *this;
+  }
+  pos_++;
+  while (pos_ == node_->count) {
+    if (node_->parent == nullptr) {
+      node_ = nullptr;
+      pos_ = 0;
+      return *this;
+    }
+    pos_ = node_->slot;
+    node_ = node_->parent;
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator &
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator::operator--()
+    noexcept {
+  if (node_ == nullptr) {
+    node_ = tree_->root_;
+    if (node_ == nullptr) {
+      return *this;
+    }
+    while (!node_->leaf) {
+      node_ = inner_(node_)->children[node_->count];
+    }
+    pos_ = node_->count - 1;
+    return *this;
+  }
+  if (!node_->leaf) {
+    node_ = inner_(node_)->children[pos_];
+    while (!node_->leaf) {
+      node_ = inner_(node_)->children[node_->count];
+    }
+    pos_ = node_->count - 1;
+    return *this;
+  }
+  if (pos_ > 0) {
+    pos_--;
+    return *this;
+  }
+  while (node_->parent && node_->slot == 0) {
+    node_ = node_->parent;
+  }
+  if (node_->parent == nullptr) {
+    node_ = nullptr;
+    pos_ = 0;
+    return *this;
+  }
+  pos_ = node_->slot - 1;
+  node_ = node_->parent;
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::BTree(
+    std::initializer_list<value_type> const &items) {
+  for (const value_type &item : items) {
+    insert(item);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::BTree(
+    const BTree &another)
+    : comp_(another.comp_) {
+  if (another.root_) {
+    try {
+      clone_(another.root_, nullptr, 0);
+    } catch (...) {
+      destroy_(root_);
+      throw;
+    }
+    size_ = another.size_;
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::BTree(
+    BTree &&another) noexcept
+    : root_(another.root_),
+      size_(another.size_),
+      comp_(std::move(another.comp_)),
+      leaves_(std::move(another.leaves_)),
+      inners_(std::move(another.inners_)) {
+  another.root_ = nullptr;
+  another.size_ = 0;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree> &
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::operator=(
+    const BTree &another) {
+  if (this != &another) {
+    BTree copy(another);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree> &
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::operator=(
+    BTree &&another) noexcept {
+  if (this != &another) {
+    clear();
+    swap(another);
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::swap(
+    BTree &another) noexcept {
+  std::swap(root_, another.root_);
+  std::swap(size_, another.size_);
+  std::swap(comp_, another.comp_);
+  leaves_.swap(another.leaves_);
+  inners_.swap(another.inners_);
+}
+
+// Values are only visited when they have a destructor to run; the node
+// storage itself goes back to the arenas in whole pages.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::clear() noexcept {
+  if (!std::is_trivially_destructible<Value>::value && root_) {
+    destroy_(root_);
+  }
+  if (leaves_) {
+    leaves_->release();
+  }
+  if (inners_) {
+    inners_->release();
+  }
+  root_ = nullptr;
+  size_ = 0;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::destroy_(
+    node *n) noexcept {
+  if (n == nullptr) {
+    return;
+  }
+  for (size_type i = 0; i < n->count; i++) {
+    n->values()[i].~Value();
+  }
+  if (!n->leaf) {
+    for (size_type i = 0; i <= n->count; i++) {
+      destroy_(inner_(n)->children[i]);
+    }
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::node *
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::new_leaf_() {
+  if (!leaves_) {
+    leaves_ = std::make_unique<NodeArena<leaf_node>>();
+  }
+  return new (leaves_->allocate()) leaf_node;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::inner_node *
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::new_inner_() {
+  if (!inners_) {
+    inners_ = std::make_unique<NodeArena<inner_node>>();
+  }
+  inner_node *n = new (inners_->allocate()) inner_node;
+  n->leaf = false;
+  return n;
+}
+
+// The node must already be empty: its values were moved out or destroyed.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::free_node_(
+    node *n) noexcept {
+  if (n->leaf) {
+    n->~leaf_node();
+    leaves_->deallocate(n);
+  } else {
+    inner_(n)->~inner_node();
+    inners_->deallocate(n);
+  }
+}
+
+// Copies source under parent (or as the root). Children are linked before
+// they are filled and count only covers copied values, so a copy that
+// throws half way is still a tree destroy_ can walk.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::node *
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::clone_(
+    node *source, inner_node *parent, size_type slot) {
+  node *copy = source->leaf ? new_leaf_() : new_inner_();
+  if (parent) {
+    parent->children[slot] = copy;
+    copy->parent = parent;
+    copy->slot = slot;
+  } else {
+    root_ = copy;
+  }
+  if (!copy->leaf) {
+    for (size_type i = 0; i <= source->count; i++) {
+      inner_(copy)->children[i] = nullptr;
+      inner_(copy)->counts[i] = inner_(source)->counts[i];
+    }
+  }
+  for (size_type i = 0; i <= source->count; i++) {
+    if (!source->leaf) {
+      clone_(inner_(source)->children[i], inner_(copy), i);
+    }
+    if (i < source->count) {
+      new (&copy->values()[i]) Value(source->values()[i]);
+      copy->count++;
+    }
+  }
+  return copy;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::lower_index_(
+    node *n, const key_type &key) const noexcept {
+  size_type first = 0;
+  size_type len = n->count;
+  while (len > 0) {
+    size_type half = len / 2;
+    if (less_(key_of_(n, first + half), key)) {
+      first += half + 1;
+      len -= half + 1;
+    } else {
+      len = half;
+    }
+  }
+  return first;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::upper_index_(
+    node *n, const key_type &key) const noexcept {
+  size_type first = 0;
+  size_type len = n->count;
+  while (len > 0) {
+    size_type half = len / 2;
+    if (!less_(key, key_of_(n, first + half))) {
+      first += half + 1;
+      len -= half + 1;
+    } else {
+      len = half;
+    }
+  }
+  return first;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::total_(
+    node *n) noexcept {
+  size_type total = n->count;
+  if (!n->leaf) {
+    for (size_type i = 0; i <= n->count; i++) {
+      total += inner_(n)->counts[i];
+    }
+  }
+  return total;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::set_child_(
+    inner_node *parent, size_type i, node *child, size_type count) noexcept {
+  parent->children[i] = child;
+  parent->counts[i] = count;
+  child->parent = parent;
+  child->slot = i;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::move_value_(
+    Value *from, Value *to) noexcept {
+  new (to) Value(std::move(*from));
+  from->~Value();
+}
+
+// Opens a gap at index from (values, and children after from for inner
+// nodes); the caller fills it and bumps count.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::shift_right_(
+    node *n, size_type from) noexcept {
+  for (size_type i = n->count; i > from; i--) {
+    move_value_(&n->values()[i - 1], &n->values()[i]);
+  }
+  if (!n->leaf) {
+    inner_node *in = inner_(n);
+    for (size_type i = n->count + 1; i > from + 1; i--) {
+      set_child_(in, i, in->children[i - 1], in->counts[i - 1]);
+    }
+  }
+}
+
+// Closes the gap left at index from (value from and child from + 1); the
+// caller drops count.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::shift_left_(
+    node *n, size_type from) noexcept {
+  for (size_type i = from; i + 1 < n->count; i++) {
+    move_value_(&n->values()[i + 1], &n->values()[i]);
+  }
+  if (!n->leaf) {
+    inner_node *in = inner_(n);
+    for (size_type i = from + 1; i < n->count; i++) {
+      set_child_(in, i, in->children[i + 1], in->counts[i + 1]);
+    }
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::begin() const noexcept {
+  node *n = root_;
+  if (n == nullptr) {
+    return end();
+  }
+  while (!n->leaf) {
+    n = inner_(n)->children[0];
+  }
+  return Iterator(this, n, 0);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Multi,
+                         Degree>::Iterator,
+          bool>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::insert(
+    const value_type &value) {
+  return insert_(value);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Multi,
+                         Degree>::Iterator,
+          bool>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::insert(
+    value_type &&value) {
+  return insert_(std::move(value));
+}
+
+// Splits the full child i of parent around its median, which moves up
+// into parent. parent itself must not be full.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::split_child_(
+    inner_node *parent, size_type i) {
+  node *full = parent->children[i];
+  node *sibling = full->leaf ? new_leaf_() : new_inner_();
+  for (size_type j = 0; j < min_keys; j++) {
+    move_value_(&full->values()[Degree + j], &sibling->values()[j]);
+  }
+  if (!full->leaf) {
+    for (size_type j = 0; j < Degree; j++) {
+      set_child_(inner_(sibling), j, inner_(full)->children[Degree + j],
+                 inner_(full)->counts[Degree + j]);
+    }
+  }
+  sibling->count = min_keys;
+  full->count = min_keys;
+  shift_right_(parent, i);
+  move_value_(&full->values()[min_keys], &parent->values()[i]);
+  parent->count++;
+  set_child_(parent, i, full, total_(full));
+  set_child_(parent, i + 1, sibling, total_(sibling));
+}
+
+// A set first checks for the key, so a rejected insertion never splits.
+// The descent then splits every full node it meets and counts the new
+// value under each child it enters.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+template <typename Arg>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Multi,
+                         Degree>::Iterator,
+          bool>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::insert_(
+    Arg &&value) {
+  const key_type &key = KeyOfValue()(value);
+  if (!Multi) {
+    Iterator existing = find(key);
+    if (existing != end()) {
+      return std::make_pair(existing, false);
+    }
+  }
+  if (root_ == nullptr) {
+    root_ = new_leaf_();
+  } else if (root_->count == max_keys) {
+    inner_node *new_root = new_inner_();
+    set_child_(new_root, 0, root_, size_);
+    root_ = new_root;
+    split_child_(new_root, 0);
+  }
+  node *n = root_;
+  while (!n->leaf) {
+    inner_node *in = inner_(n);
+    size_type i = upper_index_(n, key);
+    if (in->children[i]->count == max_keys) {
+      split_child_(in, i);
+      if (!less_(key, key_of_(n, i))) {
+        i++;
+      }
+    }
+    in->counts[i]++;
+    n = in->children[i];
+  }
+  size_type pos = upper_index_(n, key);
+  shift_right_(n, pos);
+  try {
+    new (&n->values()[pos]) Value(std::forward<Arg>(value));
+  } catch (...) {
+    for (size_type i = pos; i < n->count; i++) {
+      move_value_(&n->values()[i + 1], &n->values()[i]);
+    }
+    for (node *cur = n; cur->parent; cur = cur->parent) {
+      cur->parent->counts[cur->slot]--;
+    }
+    if (root_->count == 0) {
+      free_node_(root_);
+      root_ = nullptr;
+    }
+    throw;
+  }
+  n->count++;
+  size_++;
+  return std::make_pair(Iterator(this, n, pos), true);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::
+    rotate_from_left_(inner_node *parent, size_type i) noexcept {
+  node *child = parent->children[i];
+  node *left = parent->children[i - 1];
+  shift_right_(child, 0);
+  move_value_(&parent->values()[i - 1], &child->values()[0]);
+  move_value_(&left->values()[left->count - 1], &parent->values()[i - 1]);
+  size_type moved = 1;
+  if (!child->leaf) {
+    moved += inner_(left)->counts[left->count];
+    set_child_(inner_(child), 1, inner_(child)->children[0],
+               inner_(child)->counts[0]);
+    set_child_(inner_(child), 0, inner_(left)->children[left->count],
+               inner_(left)->counts[left->count]);
+  }
+  child->count++;
+  left->count--;
+  parent->counts[i] += moved;
+  parent->counts[i - 1] -= moved;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::
+    rotate_from_right_(inner_node *parent, size_type i) noexcept {
+  node *child = parent->children[i];
+  node *right = parent->children[i + 1];
+  move_value_(&parent->values()[i], &child->values()[child->count]);
+  move_value_(&right->values()[0], &parent->values()[i]);
+  size_type moved = 1;
+  if (!child->leaf) {
+    moved += inner_(right)->counts[0];
+    set_child_(inner_(child), child->count + 1, inner_(right)->children[0],
+               inner_(right)->counts[0]);
+    set_child_(inner_(right), 0, inner_(right)->children[1],
+               inner_(right)->counts[1]);
+  }
+  child->count++;
+  shift_left_(right, 0);
+  right->count--;
+  parent->counts[i] += moved;
+  parent->counts[i + 1] -= moved;
+}
+
+// Folds separator i and child i + 1 into child i. Both children hold the
+// minimum number of values, so the result is exactly full.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::merge_children_(
+    inner_node *parent, size_type i) noexcept {
+  node *left = parent->children[i];
+  node *right = parent->children[i + 1];
+  size_type base = left->count;
+  move_value_(&parent->values()[i], &left->values()[base]);
+  for (size_type j = 0; j < right->count; j++) {
+    move_value_(&right->values()[j], &left->values()[base + 1 + j]);
+  }
+  if (!left->leaf) {
+    for (size_type j = 0; j <= right->count; j++) {
+      set_child_(inner_(left), base + 1 + j, inner_(right)->children[j],
+                 inner_(right)->counts[j]);
+    }
+  }
+  left->count = base + 1 + right->count;
+  parent->counts[i] += 1 + parent->counts[i + 1];
+  shift_left_(parent, i);
+  parent->count--;
+  right->count = 0;
+  free_node_(right);
+}
+
+// Removes and returns the value with in-order index `index` under n. Every
+// child entered is first given more than the minimum number of values, so
+// the removal never has to walk back up.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+Value BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::remove_at_(
+    node *n, size_type index) {
+  if (n->leaf) {
+    Value removed(std::move(n->values()[index]));
+    n->values()[index].~Value();
+    for (size_type i = index; i + 1 < n->count; i++) {
+      move_value_(&n->values()[i + 1], &n->values()[i]);
+    }
+    n->count--;
+    return removed;
+  }
+  inner_node *in = inner_(n);
+  size_type i = 0;
+  while (index >= in->counts[i]) {
+    index -= in->counts[i];
+    if (index == 0) {
+      node *left = in->children[i];
+      node *right = in->children[i + 1];
+      if (left->count > min_keys) {
+        Value predecessor = remove_at_(left, in->counts[i] - 1);
+        in->counts[i]--;
+        Value removed(std::move(n->values()[i]));
+        n->values()[i] = std::move(predecessor);
+        return removed;
+      }
+      if (right->count > min_keys) {
+        Value successor = remove_at_(right, 0);
+        in->counts[i + 1]--;
+        Value removed(std::move(n->values()[i]));
+        n->values()[i] = std::move(successor);
+        return removed;
+      }
+      index = in->counts[i];
+      merge_children_(in, i);
+      break;
+    }
+    index--;
+    i++;
+  }
+  if (in->children[i]->count == min_keys) {
+    if (i > 0 && in->children[i - 1]->count > min_keys) {
+      size_type before = in->counts[i];
+      rotate_from_left_(in, i);
+      index += in->counts[i] - before;
+    } else if (i < n->count && in->children[i + 1]->count > min_keys) {
+      rotate_from_right_(in, i);
+    } else if (i < n->count) {
+      merge_children_(in, i);
+    } else {
+      index += in->counts[i - 1] + 1;
+      merge_children_(in, i - 1);
+      i--;
+    }
+  }
+  Value removed = remove_at_(in->children[i], index);
+  in->counts[i]--;
+  return removed;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::index_of_(
+    const Iterator &it) const noexcept {
+  node *n = it.node_;
+  size_type index = it.pos_;
+  if (!n->leaf) {
+    for (size_type i = 0; i <= it.pos_; i++) {
+      index += inner_(n)->counts[i];
+    }
+  }
+  while (n->parent) {
+    for (size_type i = 0; i < n->slot; i++) {
+      index += n->parent->counts[i] + 1;
+    }
+    n = n->parent;
+  }
+  return index;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+void BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::erase(
+    Iterator pos) {
+  if (pos.node_ == nullptr) {
+    throw std::out_of_range("cannot erase end()");
+  }
+  remove_at_(root_, index_of_(pos));
+  size_--;
+  if (root_->count == 0) {
+    node *old_root = root_;
+    if (root_->leaf) {
+      root_ = nullptr;
+    } else {
+      root_ = inner_(root_)->children[0];
+      root_->parent = nullptr;
+      root_->slot = 0;
+    }
+    free_node_(old_root);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::erase(
+    const key_type &key) {
+  size_type removed = 0;
+  for (Iterator it = find(key); it != end(); it = find(key)) {
+    erase(it);
+    removed++;
+  }
+  return removed;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::find(
+    const key_type &key) const noexcept {
+  node *n = root_;
+  while (n) {
+    size_type i = lower_index_(n, key);
+    if (i < n->count && !less_(key, key_of_(n, i))) {
+      return Iterator(this, n, i);
+    }
+    if (n->leaf) {
+      break;
+    }
+    n = inner_(n)->children[i];
+  }
+  return end();
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+bool BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::contains(
+    const key_type &key) const noexcept {
+  return find(key) != end();
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::count(
+    const key_type &key) const noexcept {
+  if (!Multi) {
+    return contains(key) ? 1 : 0;
+  }
+  size_type below = rank(key);
+  size_type not_above = 0;
+  for (node *n = root_; n;) {
+    size_type i = upper_index_(n, key);
+    not_above += i;
+    if (n->leaf) {
+      break;
+    }
+    for (size_type j = 0; j < i; j++) {
+      not_above += inner_(n)->counts[j];
+    }
+    n = inner_(n)->children[i];
+  }
+  return not_above - below;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::lower_bound(
+    const key_type &key) const noexcept {
+  Iterator best = end();
+  for (node *n = root_; n;) {
+    size_type i = lower_index_(n, key);
+    if (i < n->count) {
+      best = Iterator(this, n, i);
+    }
+    if (n->leaf) {
+      break;
+    }
+    n = inner_(n)->children[i];
+  }
+  return best;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::upper_bound(
+    const key_type &key) const noexcept {
+  Iterator best = end();
+  for (node *n = root_; n;) {
+    size_type i = upper_index_(n, key);
+    if (i < n->count) {
+      best = Iterator(this, n, i);
+    }
+    if (n->leaf) {
+      break;
+    }
+    n = inner_(n)->children[i];
+  }
+  return best;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+std::pair<typename BTree<Key, Value, KeyOfValue, Compare, Multi,
+                         Degree>::Iterator,
+          typename BTree<Key, Value, KeyOfValue, Compare, Multi,
+                         Degree>::Iterator>
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::equal_range(
+    const key_type &key) const noexcept {
+  return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+// Returns the element with in-order index `index`, or end() if there is
+// none.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::Iterator
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::nth(
+    size_type index) const noexcept {
+  if (index >= size_) {
+    return end();
+  }
+  node *n = root_;
+  while (!n->leaf) {
+    inner_node *in = inner_(n);
+    size_type i = 0;
+    while (index >= in->counts[i]) {
+      index -= in->counts[i];
+      if (index == 0) {
+        return Iterator(this, n, i);
+      }
+      index--;
+      i++;
+    }
+    n = in->children[i];
+  }
+  return Iterator(this, n, index);
+}
+
+// Number of elements ordered strictly before key.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare, bool Multi, size_t Degree>
+typename BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::size_type
+BTree<Key, Value, KeyOfValue, Compare, Multi, Degree>::rank(
+    const key_type &key) const noexcept {
+  size_type below = 0;
+  for (node *n = root_; n;) {
+    size_type i = lower_index_(n, key);
+    below += i;
+    if (n->leaf) {
+      break;
+    }
+    for (size_type j = 0; j < i; j++) {
+      below += inner_(n)->counts[j];
+    }
+    n = inner_(n)->children[i];
+  }
+  return below;
+}
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef CPP2_S21_CONTAINERS_2_BTREE_S21_BTREE_H_
+#define CPP2_S21_CONTAINERS_2_BTREE_S21_BTREE_H_
+
+#include <type_traits>
+
+#include "../map/s21_map.h"
+#include "../multiset/s21_multiset.h"
+#include "../set/s21_set.h"
+#include "btree.h"
+
+namespace s21 {
+
+template <typename T, typename Compare = std::less<T>>
+class S21BTreeSet : public BTree<T, T, BTreeIdentity, Compare, false> {
+  using Tree = BTree<T, T, BTreeIdentity, Compare, false>;
+
+ public:
+  using Tree::Tree;
+};
+
+template <typename T, typename Compare = std::less<T>>
+class S21BTreeMultiset : public BTree<T, T, BTreeIdentity, Compare, true> {
+  using Tree = BTree<T, T, BTreeIdentity, Compare, true>;
+
+ public:
+  using Tree::Tree;
+};
+
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class S21BTreeMap : public BTree<Key, std::pair<Key, T>, BTreeSelectFirst,
+                                 Compare, false> {
+  using Tree =
+      BTree<Key, std::pair<Key, T>, BTreeSelectFirst, Compare, false>;
+
+ public:
+  using mapped_type = T;
+  using typename Tree::iterator;
+  using typename Tree::value_type;
+  using Tree::insert;
+  using Tree::Tree;
+
+  T &at(const Key &key) {
+    iterator it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("key not found");
+    }
+    return it->second;
+  }  // access a specified element with bounds checking
+  T &operator[](const Key &key) {
+    iterator it = this->find(key);
+    if (it == this->end()) {
+      it = insert(value_type(key, T())).first;
+    }
+    return it->second;
+  }  // access or insert specified element
+  std::pair<iterator, bool> insert(const Key &key, const T &obj) {
+    return insert(value_type(key, obj));
+  }  // inserts a value by key unless the key is already present
+  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj) {
+    std::pair<iterator, bool> result = insert(key, obj);
+    if (!result.second) {
+      result.first->second = obj;
+    }
+    return result;
+  }  // inserts an element or assigns to the one with the same key
+};
+
+// Storage engines for the ordered containers: the AVL node tree behind
+// S21Set, S21Map and S21Multiset, or the B-tree, which keeps many values
+// per node and takes far fewer cache misses per lookup on large trees.
+struct NodeTreeEngine {};
+struct BTreeEngine {};
+
+template <typename T, typename Compare = std::less<T>,
+          typename Engine = NodeTreeEngine>
+using OrderedSet =
+    typename std::conditional<std::is_same<Engine, BTreeEngine>::value,
+                              S21BTreeSet<T, Compare>,
+                              S21Set<T, Compare>>::type;
+
+template <typename T, typename Compare = std::less<T>,
+          typename Engine = NodeTreeEngine>
+using OrderedMultiset =
+    typename std::conditional<std::is_same<Engine, BTreeEngine>::value,
+                              S21BTreeMultiset<T, Compare>,
+                              S21Multiset<T, Compare>>::type;
+
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Engine = NodeTreeEngine>
+using OrderedMap =
+    typename std::conditional<std::is_same<Engine, BTreeEngine>::value,
+                              S21BTreeMap<Key, T, Compare>,
+                              S21Map<Key, T, Compare>>::type;
+
+}  // namespace s21
+
+#endif
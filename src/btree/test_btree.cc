@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+#include "../s21_containersplus.h"
+
+template <size_t Degree>
+using SmallSet = s21::BTree<int, int, s21::BTreeIdentity, std::less<int>,
+                            false, Degree>;
+template <size_t Degree>
+using SmallMultiset = s21::BTree<int, int, s21::BTreeIdentity,
+                                 std::less<int>, true, Degree>;
+
+template <typename Tree, typename Reference>
+void ExpectSameContents(const Tree &tree, const Reference &reference) {
+  ASSERT_EQ(tree.size(), reference.size());
+  auto it = tree.begin();
+  size_t index = 0;
+  for (const auto &value : reference) {
+    ASSERT_EQ(*it, value);
+    ASSERT_EQ(*tree.nth(index), value);
+    ++it;
+    ++index;
+  }
+  EXPECT_TRUE(it == tree.end());
+}
+
+TEST(BTreeTest, InsertFindErase) {
+  s21::S21BTreeSet<int> s{5, 1, 4, 1, 3};
+  EXPECT_EQ(s.size(), 4U);
+  EXPECT_TRUE(s.contains(4));
+  EXPECT_FALSE(s.contains(2));
+  EXPECT_FALSE(s.insert(3).second);
+  EXPECT_EQ(*s.insert(2).first, 2);
+  s.erase(s.find(1));
+  EXPECT_EQ(s.erase(7), 0U);
+  EXPECT_EQ(*s.begin(), 2);
+  EXPECT_EQ(s.rank(4), 2U);
+  EXPECT_THROW(s.erase(s.end()), std::out_of_range);
+}
+
+TEST(BTreeTest, IterateBothDirections) {
+  SmallSet<2> s;
+  for (int i = 0; i < 500; i++) {
+    s.insert((i * 37) % 500);
+  }
+  int expected = 0;
+  for (auto it = s.begin(); it != s.end(); ++it, ++expected) {
+    ASSERT_EQ(*it, expected);
+  }
+  auto it = s.end();
+  for (int i = 499; i >= 0; i--) {
+    --it;
+    ASSERT_EQ(*it, i);
+  }
+}
+
+TEST(BTreeTest, RandomOperationsMatchStdSet) {
+  std::mt19937 generator(7);
+  SmallSet<2> small;
+  SmallSet<3> wider;
+  std::set<int> reference;
+  for (int step = 0; step < 20000; step++) {
+    int value = generator() % 1000;
+    if (generator() % 3 == 0) {
+      EXPECT_EQ(small.erase(value), reference.erase(value));
+      wider.erase(value);
+    } else {
+      EXPECT_EQ(small.insert(value).second, reference.insert(value).second);
+      wider.insert(value);
+    }
+  }
+  ExpectSameContents(small, reference);
+  ExpectSameContents(wider, reference);
+  auto below = std::distance(reference.begin(), reference.lower_bound(500));
+  EXPECT_EQ(small.rank(500), static_cast<size_t>(below));
+}
+
+TEST(BTreeTest, MultisetKeepsDuplicates) {
+  std::mt19937 generator(11);
+  SmallMultiset<2> s;
+  std::multiset<int> reference;
+  for (int step = 0; step < 5000; step++) {
+    int value = generator() % 100;
+    if (generator() % 4 == 0) {
+      auto it = s.find(value);
+      auto reference_it = reference.find(value);
+      if (reference_it != reference.end()) {
+        s.erase(it);
+        reference.erase(reference_it);
+      }
+    } else {
+      s.insert(value);
+      reference.insert(value);
+    }
+  }
+  ExpectSameContents(s, reference);
+  for (int value = 0; value < 100; value++) {
+    ASSERT_EQ(s.count(value), reference.count(value));
+  }
+  auto range = s.equal_range(42);
+  EXPECT_EQ(static_cast<size_t>(std::distance(range.first, range.second)),
+            reference.count(42));
+  EXPECT_EQ(s.erase(42), reference.erase(42));
+  EXPECT_EQ(s.count(42), 0U);
+}
+
+TEST(BTreeTest, MapOwnsStrings) {
+  s21::S21BTreeMap<int, std::string> m{{1, "one"}, {2, "two"}};
+  for (int i = 3; i < 300; i++) {
+    m[i] = std::to_string(i);
+  }
+  EXPECT_EQ(m.at(2), "two");
+  EXPECT_THROW(m.at(1000), std::out_of_range);
+  EXPECT_FALSE(m.insert(1, "uno").second);
+  EXPECT_FALSE(m.insert_or_assign(1, "uno").second);
+  s21::S21BTreeMap<int, std::string> copy(m);
+  m.erase(1);
+  EXPECT_EQ(copy.at(1), "uno");
+  EXPECT_FALSE(m.contains(1));
+  EXPECT_EQ(copy.size(), 299U);
+  s21::S21BTreeMap<int, std::string> moved(std::move(copy));
+  EXPECT_EQ(moved.nth(150)->second, "151");
+  EXPECT_TRUE(copy.empty());
+}
+
+TEST(BTreeTest, EngineSelection) {
+  static_assert(std::is_same<s21::OrderedSet<int>, s21::S21Set<int>>::value,
+                "the node tree is the default engine");
+  static_assert(
+      std::is_same<s21::OrderedMap<int, int, std::less<int>, s21::BTreeEngine>,
+                   s21::S21BTreeMap<int, int>>::value,
+      "BTreeEngine selects the B-tree");
+  s21::OrderedMultiset<int, std::less<int>, s21::BTreeEngine> s{3, 1, 3};
+  EXPECT_EQ(s.count(3), 2U);
+}
@@ -0,0 +1,785 @@
+#ifndef CPP2_S21_CONTAINERS_2_COMPACT_COMPACT_TREE_H_
+#define CPP2_S21_CONTAINERS_2_COMPACT_COMPACT_TREE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../binary_search_tree/binary_search_tree.h"
+
+namespace s21 {
+
+// AVL tree whose nodes live in one vector and link to each other by 32-bit
+// index. A node is the value plus 12 bytes: two child indexes and one word
+// holding the subtree size in its low 30 bits and the balance factor in
+// the top 2, so an S21CompactSet<int> takes 16 bytes per element where the
+// pointer-based S21Set takes 56. There are no parent links: insertion and
+// erasure are recursive descents that rebalance on the way back up, and
+// the vector is kept dense by moving the last node into every hole an
+// erasure leaves. Any insertion or erasure invalidates every iterator.
+// Holds at most 2^30 - 1 elements.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+class CompactTree {
+ public:
+  class Iterator;
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+  using index_type = uint32_t;
+
+  CompactTree() noexcept = default;
+  explicit CompactTree(const Compare &comp) noexcept : comp_(comp) {}
+  CompactTree(std::initializer_list<value_type> const &items);
+
+  Iterator begin() const noexcept;
+  Iterator end() const noexcept { return Iterator(this, nil, size()); }
+  bool empty() const noexcept { return nodes_.empty(); }
+  size_type size() const noexcept { return nodes_.size(); }
+  size_type max_size() const noexcept { return size_mask; }
+  key_compare key_comp() const { return comp_; }
+  void reserve(size_type count);  // makes room for count elements up front
+  void shrink_to_fit() { nodes_.shrink_to_fit(); }
+  size_type memory_usage() const noexcept {
+    return nodes_.capacity() * sizeof(node);
+  }  // bytes held by the node storage
+
+  std::pair<Iterator, bool> insert(const value_type &value);
+  std::pair<Iterator, bool> insert(value_type &&value);
+  void erase(Iterator pos);
+  size_type erase(const key_type &key);
+  void clear() noexcept;
+  void swap(CompactTree &another) noexcept;
+  template <typename ForwardIt>
+  void load_sorted(ForwardIt first, ForwardIt last);
+
+  Iterator find(const key_type &key) const noexcept;
+  bool contains(const key_type &key) const noexcept;
+  size_type count(const key_type &key) const noexcept;
+  Iterator lower_bound(const key_type &key) const noexcept;
+  Iterator upper_bound(const key_type &key) const noexcept;
+  std::pair<Iterator, Iterator> equal_range(const key_type &key) const noexcept;
+  Iterator nth(size_type index) const noexcept;
+  size_type rank(const key_type &key) const noexcept;
+
+ protected:
+  static constexpr index_type nil = UINT32_MAX;
+  static constexpr uint32_t size_mask = (uint32_t(1) << 30) - 1;
+  static constexpr int balance_shift = 30;
+  struct node {
+    Value value;
+    index_type child[2];  // left, right; nil when absent
+    uint32_t meta;        // subtree size | (balance + 1) << balance_shift
+  };
+
+  std::vector<node> nodes_;
+  index_type root_ = nil;
+  Compare comp_ = Compare();
+
+  // State threaded through the recursive insertion and erasure.
+  struct descent_ {
+    index_type found = nil;  // the inserted, existing or removed node
+    size_type rank = 0;      // in-order index of found, for insertion
+    bool changed = false;    // an element was inserted or removed
+    bool height = false;     // the subtree grew (insert) or shrank (erase)
+  };
+
+  bool less_(const key_type &a, const key_type &b) const {
+    return compare_less(comp_, a, b);
+  }
+  const key_type &key_of_(index_type i) const noexcept {
+    return KeyOfValue()(nodes_[i].value);
+  }
+  index_type &left_(index_type i) noexcept { return nodes_[i].child[0]; }
+  index_type &right_(index_type i) noexcept { return nodes_[i].child[1]; }
+  index_type left_(index_type i) const noexcept { return nodes_[i].child[0]; }
+  index_type right_(index_type i) const noexcept {
+    return nodes_[i].child[1];
+  }
+  size_type size_of_(index_type i) const noexcept {
+    return i == nil ? 0 : nodes_[i].meta & size_mask;
+  }
+  int balance_of_(index_type i) const noexcept {
+    return static_cast<int>(nodes_[i].meta >> balance_shift) - 1;
+  }
+  void set_balance_(index_type i, int balance) noexcept {
+    nodes_[i].meta = (nodes_[i].meta & size_mask) |
+                     static_cast<uint32_t>(balance + 1) << balance_shift;
+  }
+  void update_size_(index_type i) noexcept {
+    nodes_[i].meta = (nodes_[i].meta & ~size_mask) |
+                     static_cast<uint32_t>(1 + size_of_(left_(i)) +
+                                           size_of_(right_(i)));
+  }
+
+  index_type rotate_left_(index_type t) noexcept;
+  index_type rotate_right_(index_type t) noexcept;
+  index_type fix_left_heavy_(index_type t, bool &dropped) noexcept;
+  index_type fix_right_heavy_(index_type t, bool &dropped) noexcept;
+  index_type left_shrank_(index_type t, bool &shrunk) noexcept;
+  index_type right_shrank_(index_type t, bool &shrunk) noexcept;
+
+  template <typename Arg>
+  std::pair<Iterator, bool> insert_(Arg &&value);
+  template <typename Arg>
+  index_type insert_into_(index_type t, const key_type &key, Arg &value,
+                          descent_ &state);
+  index_type erase_from_(index_type t, const key_type &key,
+                         descent_ &state) noexcept;
+  index_type remove_min_(index_type t, index_type &min,
+                         bool &shrunk) noexcept;
+  void release_(index_type hole) noexcept;
+  index_type link_balanced_(index_type first, index_type count,
+                            int &height) noexcept;
+  index_type select_(size_type index) const noexcept;
+  index_type leftmost_(index_type t) const noexcept;
+  index_type rightmost_(index_type t) const noexcept;
+};
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+class CompactTree<Key, Value, KeyOfValue, Compare>::Iterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Value *;
+  using reference = Value &;
+
+  Iterator() noexcept = default;
+  reference operator*() const noexcept {
+    return const_cast<Value &>(tree_->nodes_[index_].value);
+  }
+  pointer operator->() const noexcept { return &**this; }
+  Iterator &operator++() noexcept;
+  Iterator operator++(int) noexcept {
+    Iterator old = *this;
+    ++*this;
+    return old;
+  }
+  Iterator &operator--() noexcept;
+  Iterator operator--(int) noexcept {
+    Iterator old = *this;
+    --*this;
+    return old;
+  }
+  difference_type operator-(const Iterator &another) const noexcept {
+    return static_cast<difference_type>(rank_) -
+           static_cast<difference_type>(another.rank_);
+  }
+  bool operator==(const Iterator &another) const noexcept {
+    return index_ == another.index_;
+  }
+  bool operator!=(const Iterator &another) const noexcept {
+    return !(*this == another);
+  }
+
+ private:
+  friend class CompactTree;
+  Iterator(const CompactTree *tree, index_type index, size_type rank) noexcept
+      : tree_(tree), index_(index), rank_(rank) {}
+  const CompactTree *tree_ = nullptr;
+  index_type index_ = nil;  // nil for end()
+  size_type rank_ = 0;      // in-order index, size() for end()
+};
+
+// Without parent links the successor is the leftmost node of the right
+// subtree when there is one, and is otherwise found again from the root
+// by its in-order index.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator &
+CompactTree<Key, Value, KeyOfValue, Compare>::Iterator::operator++() noexcept {
+  if (index_ == nil) {
+    *this = tree_->begin();
+    return *this;
+  }
+  rank_++;
+  index_type right = tree_->right_(index_);
+  index_ = right != nil ? tree_->leftmost_(right) : tree_->select_(rank_);
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator &
+CompactTree<Key, Value, KeyOfValue, Compare>::Iterator::operator--() noexcept {
+  if (rank_ == 0) {
+    index_ = nil;
+    rank_ = tree_->size();
+    return *this;
+  }
+  rank_--;
+  index_type left = index_ == nil ? nil : tree_->left_(index_);
+  index_ = left != nil ? tree_->rightmost_(left) : tree_->select_(rank_);
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+CompactTree<Key, Value, KeyOfValue, Compare>::CompactTree(
+    std::initializer_list<value_type> const &items) {
+  for (const value_type &item : items) {
+    insert(item);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator
+CompactTree<Key, Value, KeyOfValue, Compare>::begin() const noexcept {
+  if (root_ == nil) {
+    return end();
+  }
+  return Iterator(this, leftmost_(root_), 0);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+void CompactTree<Key, Value, KeyOfValue, Compare>::reserve(size_type count) {
+  if (count > max_size()) {
+    throw std::length_error("compact tree holds at most 2^30 - 1 elements");
+  }
+  nodes_.reserve(count);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+std::pair<typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+CompactTree<Key, Value, KeyOfValue, Compare>::insert(const value_type &value) {
+  return insert_(value);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+std::pair<typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+CompactTree<Key, Value, KeyOfValue, Compare>::insert(value_type &&value) {
+  return insert_(std::move(value));
+}
+
+// Room for the new node is made before the descent, so appending it at
+// the bottom never reallocates the vector under the recursion.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+template <typename Arg>
+std::pair<typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+CompactTree<Key, Value, KeyOfValue, Compare>::insert_(Arg &&value) {
+  if (nodes_.size() == nodes_.capacity()) {
+    if (nodes_.size() == max_size()) {
+      throw std::length_error("compact tree holds at most 2^30 - 1 elements");
+    }
+    size_type grown = nodes_.empty() ? 16 : nodes_.size() * 2;
+    nodes_.reserve(grown < max_size() ? grown : max_size());
+  }
+  descent_ state;
+  root_ = insert_into_(root_, KeyOfValue()(value), value, state);
+  return std::make_pair(Iterator(this, state.found, state.rank),
+                        state.changed);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+template <typename Arg>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::insert_into_(index_type t,
+                                                           const key_type &key,
+                                                           Arg &value,
+                                                           descent_ &state) {
+  if (t == nil) {
+    nodes_.push_back(
+        node{std::forward<Arg>(value), {nil, nil}, 1u << balance_shift | 1});
+    state.found = static_cast<index_type>(nodes_.size() - 1);
+    state.changed = true;
+    state.height = true;
+    return state.found;
+  }
+  if (less_(key, key_of_(t))) {
+    index_type left = insert_into_(left_(t), key, value, state);
+    left_(t) = left;
+    if (!state.changed) {
+      return t;
+    }
+    update_size_(t);
+    if (state.height) {
+      int balance = balance_of_(t);
+      if (balance == -1) {
+        bool dropped = false;
+        t = fix_left_heavy_(t, dropped);
+        state.height = false;
+      } else {
+        set_balance_(t, balance - 1);
+        state.height = balance == 0;
+      }
+    }
+    return t;
+  }
+  if (less_(key_of_(t), key)) {
+    state.rank += size_of_(left_(t)) + 1;
+    index_type right = insert_into_(right_(t), key, value, state);
+    right_(t) = right;
+    if (!state.changed) {
+      return t;
+    }
+    update_size_(t);
+    if (state.height) {
+      int balance = balance_of_(t);
+      if (balance == 1) {
+        bool dropped = false;
+        t = fix_right_heavy_(t, dropped);
+        state.height = false;
+      } else {
+        set_balance_(t, balance + 1);
+        state.height = balance == 0;
+      }
+    }
+    return t;
+  }
+  state.found = t;
+  state.rank += size_of_(left_(t));
+  return t;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+void CompactTree<Key, Value, KeyOfValue, Compare>::erase(Iterator pos) {
+  if (pos.index_ == nil) {
+    throw std::out_of_range("cannot erase end()");
+  }
+  erase(key_of_(pos.index_));
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::size_type
+CompactTree<Key, Value, KeyOfValue, Compare>::erase(const key_type &key) {
+  descent_ state;
+  root_ = erase_from_(root_, key, state);
+  if (!state.changed) {
+    return 0;
+  }
+  release_(state.found);
+  return 1;
+}
+
+// A node with two children is replaced by its successor, relinked in its
+// place; values never move during the descent.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::erase_from_(
+    index_type t, const key_type &key, descent_ &state) noexcept {
+  if (t == nil) {
+    return nil;
+  }
+  if (less_(key, key_of_(t))) {
+    index_type left = erase_from_(left_(t), key, state);
+    left_(t) = left;
+    if (!state.changed) {
+      return t;
+    }
+    update_size_(t);
+    return state.height ? left_shrank_(t, state.height) : t;
+  }
+  if (less_(key_of_(t), key)) {
+    index_type right = erase_from_(right_(t), key, state);
+    right_(t) = right;
+    if (!state.changed) {
+      return t;
+    }
+    update_size_(t);
+    return state.height ? right_shrank_(t, state.height) : t;
+  }
+  state.found = t;
+  state.changed = true;
+  state.height = true;
+  if (left_(t) == nil) {
+    return right_(t);
+  }
+  if (right_(t) == nil) {
+    return left_(t);
+  }
+  index_type successor = nil;
+  bool shrunk = false;
+  index_type right = remove_min_(right_(t), successor, shrunk);
+  left_(successor) = left_(t);
+  right_(successor) = right;
+  nodes_[successor].meta = nodes_[t].meta;
+  update_size_(successor);
+  if (shrunk) {
+    return right_shrank_(successor, state.height);
+  }
+  state.height = false;
+  return successor;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::remove_min_(
+    index_type t, index_type &min, bool &shrunk) noexcept {
+  if (left_(t) == nil) {
+    min = t;
+    shrunk = true;
+    return right_(t);
+  }
+  index_type left = remove_min_(left_(t), min, shrunk);
+  left_(t) = left;
+  update_size_(t);
+  return shrunk ? left_shrank_(t, shrunk) : t;
+}
+
+// The erased node's slot is refilled with the last node of the vector,
+// whose parent is found by descending to its key.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+void CompactTree<Key, Value, KeyOfValue, Compare>::release_(
+    index_type hole) noexcept {
+  index_type last = static_cast<index_type>(nodes_.size() - 1);
+  if (hole != last) {
+    const key_type &key = key_of_(last);
+    index_type *link = &root_;
+    while (*link != last) {
+      index_type cur = *link;
+      link = &nodes_[cur].child[less_(key_of_(cur), key) ? 1 : 0];
+    }
+    *link = hole;
+    nodes_[hole] = std::move(nodes_[last]);
+  }
+  nodes_.pop_back();
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::rotate_left_(
+    index_type t) noexcept {
+  index_type pivot = right_(t);
+  right_(t) = left_(pivot);
+  left_(pivot) = t;
+  update_size_(t);
+  update_size_(pivot);
+  return pivot;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::rotate_right_(
+    index_type t) noexcept {
+  index_type pivot = left_(t);
+  left_(t) = right_(pivot);
+  right_(pivot) = t;
+  update_size_(t);
+  update_size_(pivot);
+  return pivot;
+}
+
+// Restores t, whose left subtree is now two levels taller than its right.
+// dropped tells whether the subtree ends up one level lower than it was
+// before the rotation, which only fails to happen when the left child was
+// balanced (possible after an erasure only).
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::fix_left_heavy_(
+    index_type t, bool &dropped) noexcept {
+  index_type left = left_(t);
+  int left_balance = balance_of_(left);
+  if (left_balance <= 0) {
+    index_type root = rotate_right_(t);
+    set_balance_(t, left_balance == 0 ? -1 : 0);
+    set_balance_(root, left_balance == 0 ? 1 : 0);
+    dropped = left_balance != 0;
+    return root;
+  }
+  int inner_balance = balance_of_(right_(left));
+  left_(t) = rotate_left_(left);
+  index_type root = rotate_right_(t);
+  set_balance_(t, inner_balance == -1 ? 1 : 0);
+  set_balance_(left, inner_balance == 1 ? -1 : 0);
+  set_balance_(root, 0);
+  dropped = true;
+  return root;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::fix_right_heavy_(
+    index_type t, bool &dropped) noexcept {
+  index_type right = right_(t);
+  int right_balance = balance_of_(right);
+  if (right_balance >= 0) {
+    index_type root = rotate_left_(t);
+    set_balance_(t, right_balance == 0 ? 1 : 0);
+    set_balance_(root, right_balance == 0 ? -1 : 0);
+    dropped = right_balance != 0;
+    return root;
+  }
+  int inner_balance = balance_of_(left_(right));
+  right_(t) = rotate_right_(right);
+  index_type root = rotate_left_(t);
+  set_balance_(t, inner_balance == 1 ? -1 : 0);
+  set_balance_(right, inner_balance == -1 ? 1 : 0);
+  set_balance_(root, 0);
+  dropped = true;
+  return root;
+}
+
+// t's left subtree lost a level; shrunk tells whether t's did too.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::left_shrank_(
+    index_type t, bool &shrunk) noexcept {
+  int balance = balance_of_(t);
+  if (balance == 1) {
+    return fix_right_heavy_(t, shrunk);
+  }
+  set_balance_(t, balance + 1);
+  shrunk = balance == -1;
+  return t;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::right_shrank_(
+    index_type t, bool &shrunk) noexcept {
+  int balance = balance_of_(t);
+  if (balance == -1) {
+    return fix_left_heavy_(t, shrunk);
+  }
+  set_balance_(t, balance - 1);
+  shrunk = balance == 1;
+  return t;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+void CompactTree<Key, Value, KeyOfValue, Compare>::clear() noexcept {
+  nodes_.clear();
+  root_ = nil;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+void CompactTree<Key, Value, KeyOfValue, Compare>::swap(
+    CompactTree &another) noexcept {
+  std::swap(nodes_, another.nodes_);
+  std::swap(root_, another.root_);
+  std::swap(comp_, another.comp_);
+}
+
+// Replaces the contents with a sorted range in O(n). Nodes are stored in
+// key order, so iteration afterwards walks memory sequentially. Duplicate
+// keys keep their first occurrence; an unsorted range throws
+// std::invalid_argument and leaves the tree untouched.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+template <typename ForwardIt>
+void CompactTree<Key, Value, KeyOfValue, Compare>::load_sorted(
+    ForwardIt first, ForwardIt last) {
+  size_type count = 0;
+  for (ForwardIt prev = first, it = first; it != last; prev = it++) {
+    if (it == first) {
+      count++;
+    } else if (less_(KeyOfValue()(*it), KeyOfValue()(*prev))) {
+      throw std::invalid_argument("range is not sorted");
+    } else if (less_(KeyOfValue()(*prev), KeyOfValue()(*it))) {
+      count++;
+    }
+  }
+  if (count > max_size()) {
+    throw std::length_error("compact tree holds at most 2^30 - 1 elements");
+  }
+  std::vector<node> nodes;
+  nodes.reserve(count);
+  for (ForwardIt it = first; it != last; ++it) {
+    if (nodes.empty() ||
+        less_(KeyOfValue()(nodes.back().value), KeyOfValue()(*it))) {
+      nodes.push_back(node{*it, {nil, nil}, 0});
+    }
+  }
+  nodes_.swap(nodes);
+  int height = 0;
+  root_ = link_balanced_(0, static_cast<index_type>(count), height);
+}
+
+// Links nodes [first, first + count), already in key order, into a
+// balanced subtree and returns its root; height receives its height.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::link_balanced_(
+    index_type first, index_type count, int &height) noexcept {
+  if (count == 0) {
+    height = 0;
+    return nil;
+  }
+  index_type half = count / 2;
+  index_type middle = first + half;
+  int left_height = 0;
+  int right_height = 0;
+  left_(middle) = link_balanced_(first, half, left_height);
+  right_(middle) = link_balanced_(middle + 1, count - half - 1, right_height);
+  nodes_[middle].meta = count;
+  set_balance_(middle, right_height - left_height);
+  height = 1 + (left_height > right_height ? left_height : right_height);
+  return middle;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator
+CompactTree<Key, Value, KeyOfValue, Compare>::find(
+    const key_type &key) const noexcept {
+  Iterator it = lower_bound(key);
+  if (it.index_ != nil && less_(key, key_of_(it.index_))) {
+    return end();
+  }
+  return it;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+bool CompactTree<Key, Value, KeyOfValue, Compare>::contains(
+    const key_type &key) const noexcept {
+  return find(key) != end();
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::size_type
+CompactTree<Key, Value, KeyOfValue, Compare>::count(
+    const key_type &key) const noexcept {
+  return contains(key) ? 1 : 0;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator
+CompactTree<Key, Value, KeyOfValue, Compare>::lower_bound(
+    const key_type &key) const noexcept {
+  index_type found = nil;
+  size_type found_rank = size();
+  size_type passed = 0;
+  for (index_type cur = root_; cur != nil;) {
+    if (less_(key_of_(cur), key)) {
+      passed += size_of_(left_(cur)) + 1;
+      cur = right_(cur);
+    } else {
+      found = cur;
+      found_rank = passed + size_of_(left_(cur));
+      cur = left_(cur);
+    }
+  }
+  return Iterator(this, found, found_rank);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator
+CompactTree<Key, Value, KeyOfValue, Compare>::upper_bound(
+    const key_type &key) const noexcept {
+  index_type found = nil;
+  size_type found_rank = size();
+  size_type passed = 0;
+  for (index_type cur = root_; cur != nil;) {
+    if (!less_(key, key_of_(cur))) {
+      passed += size_of_(left_(cur)) + 1;
+      cur = right_(cur);
+    } else {
+      found = cur;
+      found_rank = passed + size_of_(left_(cur));
+      cur = left_(cur);
+    }
+  }
+  return Iterator(this, found, found_rank);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+std::pair<typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator>
+CompactTree<Key, Value, KeyOfValue, Compare>::equal_range(
+    const key_type &key) const noexcept {
+  return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::Iterator
+CompactTree<Key, Value, KeyOfValue, Compare>::nth(
+    size_type index) const noexcept {
+  if (index >= size()) {
+    return end();
+  }
+  return Iterator(this, select_(index), index);
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::size_type
+CompactTree<Key, Value, KeyOfValue, Compare>::rank(
+    const key_type &key) const noexcept {
+  return lower_bound(key).rank_;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::select_(
+    size_type index) const noexcept {
+  index_type cur = root_;
+  while (cur != nil) {
+    size_type left = size_of_(left_(cur));
+    if (index == left) {
+      return cur;
+    }
+    if (index < left) {
+      cur = left_(cur);
+    } else {
+      index -= left + 1;
+      cur = right_(cur);
+    }
+  }
+  return nil;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::leftmost_(
+    index_type t) const noexcept {
+  while (left_(t) != nil) {
+    t = left_(t);
+  }
+  return t;
+}
+
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare>
+typename CompactTree<Key, Value, KeyOfValue, Compare>::index_type
+CompactTree<Key, Value, KeyOfValue, Compare>::rightmost_(
+    index_type t) const noexcept {
+  while (right_(t) != nil) {
+    t = right_(t);
+  }
+  return t;
+}
+
+}  // namespace s21
+
+#endif
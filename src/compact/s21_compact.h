@@ -0,0 +1,61 @@
+#ifndef CPP2_S21_CONTAINERS_2_COMPACT_S21_COMPACT_H_
+#define CPP2_S21_CONTAINERS_2_COMPACT_S21_COMPACT_H_
+
+#include <stdexcept>
+#include <utility>
+
+#include "compact_tree.h"
+
+namespace s21 {
+
+// Set of unique values in the 32-bit index layout of CompactTree: the same
+// ordered operations as S21Set at a fraction of the memory per element.
+template <typename T, typename Compare = std::less<T>>
+class S21CompactSet : public CompactTree<T, T, ProjectValue, Compare> {
+  using Tree = CompactTree<T, T, ProjectValue, Compare>;
+
+ public:
+  using Tree::Tree;
+};
+
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class S21CompactMap
+    : public CompactTree<Key, std::pair<Key, T>, ProjectKey, Compare> {
+  using Tree = CompactTree<Key, std::pair<Key, T>, ProjectKey, Compare>;
+
+ public:
+  using mapped_type = T;
+  using typename Tree::iterator;
+  using typename Tree::value_type;
+  using Tree::insert;
+  using Tree::Tree;
+
+  T &at(const Key &key) {
+    iterator it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("key not found");
+    }
+    return it->second;
+  }  // access a specified element with bounds checking
+  T &operator[](const Key &key) {
+    iterator it = this->find(key);
+    if (it == this->end()) {
+      it = insert(value_type(key, T())).first;
+    }
+    return it->second;
+  }  // access or insert specified element
+  std::pair<iterator, bool> insert(const Key &key, const T &obj) {
+    return insert(value_type(key, obj));
+  }  // inserts a value by key unless the key is already present
+  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj) {
+    std::pair<iterator, bool> result = insert(key, obj);
+    if (!result.second) {
+      result.first->second = obj;
+    }
+    return result;
+  }  // inserts an element or assigns to the one with the same key
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+// Exposes the node layout to check the AVL invariants after every change.
+class CheckedCompactSet : public s21::S21CompactSet<int> {
+ public:
+  using s21::S21CompactSet<int>::S21CompactSet;
+  static constexpr size_t node_bytes = sizeof(node);
+
+  void CheckInvariants() const {
+    int height = 0;
+    EXPECT_EQ(CheckSubtree(root_, height), size());
+  }
+
+ private:
+  size_t CheckSubtree(index_type t, int &height) const {
+    if (t == nil) {
+      height = 0;
+      return 0;
+    }
+    int left_height = 0;
+    int right_height = 0;
+    size_t count = CheckSubtree(left_(t), left_height) + 1 +
+                   CheckSubtree(right_(t), right_height);
+    EXPECT_EQ(size_of_(t), count);
+    EXPECT_EQ(balance_of_(t), right_height - left_height);
+    height = 1 + std::max(left_height, right_height);
+    return count;
+  }
+};
+
+template <typename Tree, typename Reference>
+void ExpectSameContents(const Tree &tree, const Reference &reference) {
+  ASSERT_EQ(tree.size(), reference.size());
+  auto it = tree.begin();
+  size_t index = 0;
+  for (const auto &value : reference) {
+    ASSERT_EQ(*it, value);
+    ASSERT_EQ(*tree.nth(index), value);
+    ++it;
+    ++index;
+  }
+  EXPECT_TRUE(it == tree.end());
+}
+
+TEST(CompactTest, InsertFindErase) {
+  s21::S21CompactSet<int> s{5, 1, 4, 1, 3};
+  EXPECT_EQ(s.size(), 4U);
+  EXPECT_TRUE(s.contains(4));
+  EXPECT_FALSE(s.contains(2));
+  EXPECT_FALSE(s.insert(3).second);
+  auto inserted = s.insert(2);
+  EXPECT_TRUE(inserted.second);
+  EXPECT_EQ(*inserted.first, 2);
+  EXPECT_EQ(inserted.first - s.begin(), 1);
+  s.erase(s.find(1));
+  EXPECT_EQ(s.erase(7), 0U);
+  EXPECT_EQ(*s.begin(), 2);
+  EXPECT_EQ(s.rank(4), 2U);
+  EXPECT_EQ(*s.lower_bound(4), 4);
+  EXPECT_EQ(*s.upper_bound(4), 5);
+  EXPECT_TRUE(s.upper_bound(5) == s.end());
+  EXPECT_THROW(s.erase(s.end()), std::out_of_range);
+}
+
+TEST(CompactTest, RandomOperationsMatchStdSet) {
+  std::mt19937 random(11);
+  CheckedCompactSet s;
+  std::set<int> reference;
+  for (int step = 0; step < 20000; step++) {
+    int value = static_cast<int>(random() % 3000);
+    if (random() % 3 == 0) {
+      EXPECT_EQ(s.erase(value), reference.erase(value));
+    } else {
+      auto result = s.insert(value);
+      auto expected = reference.insert(value);
+      ASSERT_EQ(result.second, expected.second);
+      ASSERT_EQ(*result.first, value);
+      ASSERT_EQ(static_cast<size_t>(result.first - s.begin()),
+                static_cast<size_t>(
+                    std::distance(reference.begin(), expected.first)));
+    }
+    if (step % 1000 == 0) {
+      s.CheckInvariants();
+    }
+  }
+  s.CheckInvariants();
+  ExpectSameContents(s, reference);
+  auto it = s.end();
+  for (auto expected = reference.rbegin(); expected != reference.rend();
+       ++expected) {
+    --it;
+    ASSERT_EQ(*it, *expected);
+  }
+}
+
+TEST(CompactTest, SixteenBytesPerInt) {
+  EXPECT_EQ(CheckedCompactSet::node_bytes, 16U);
+  s21::S21CompactSet<int> s;
+  s.reserve(1000);
+  EXPECT_EQ(s.memory_usage(), 16000U);
+  EXPECT_THROW(s.reserve(s.max_size() + 1), std::length_error);
+}
+
+TEST(CompactTest, LoadSorted) {
+  std::vector<int> sorted;
+  for (int i = 0; i < 1000; i++) {
+    sorted.push_back(i / 2 * 3);
+  }
+  CheckedCompactSet s;
+  s.load_sorted(sorted.begin(), sorted.end());
+  s.CheckInvariants();
+  std::set<int> reference(sorted.begin(), sorted.end());
+  ExpectSameContents(s, reference);
+  for (int i = 0; i < 600; i += 3) {
+    s.erase(i);
+  }
+  s.CheckInvariants();
+  std::vector<int> unsorted = {1, 3, 2};
+  EXPECT_THROW(s.load_sorted(unsorted.begin(), unsorted.end()),
+               std::invalid_argument);
+  EXPECT_EQ(s.size(), 300U);
+}
+
+TEST(CompactTest, MapOperations) {
+  s21::S21CompactMap<std::string, int> m;
+  m["b"] = 2;
+  m.insert("a", 1);
+  m.insert_or_assign("c", 3);
+  m.insert_or_assign("a", 10);
+  EXPECT_EQ(m.at("a"), 10);
+  EXPECT_THROW(m.at("z"), std::out_of_range);
+  EXPECT_EQ(m.size(), 3U);
+  m.erase("b");
+  std::map<std::string, int> reference = {{"a", 10}, {"c", 3}};
+  auto it = m.begin();
+  for (const auto &entry : reference) {
+    EXPECT_EQ(it->first, entry.first);
+    EXPECT_EQ(it->second, entry.second);
+    ++it;
+  }
+  EXPECT_TRUE(it == m.end());
+}
@@ -0,0 +1,94 @@
+#ifndef CPP2_S21_CONTAINERS_2_CONCURRENT_READER_EPOCHS_H_
+#define CPP2_S21_CONTAINERS_2_CONCURRENT_READER_EPOCHS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+namespace s21 {
+
+// Tracks which readers may still be looking at a retired version. A reader
+// claims a slot and writes the global epoch it started in; a writer that
+// replaced a version bumps the epoch and may free the old version once no
+// claimed slot holds an older epoch. Slots sit on separate cache lines and
+// each thread keeps reusing the slot it claimed first, so uncontended
+// readers never write to a line another core is using. enter() waits
+// while all slot_count slots are claimed, so no thread may hold more than
+// a few guards at once.
+class ReaderEpochs {
+ public:
+  static constexpr size_t slot_count = 128;
+
+  class Guard;
+
+  size_t enter() noexcept;
+  void leave(size_t slot) noexcept {
+    slots_[slot].epoch.store(0, std::memory_order_release);
+  }
+  uint64_t advance() noexcept {
+    return epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+  }  // returns the epoch new readers start in
+  uint64_t oldest_reader() const noexcept;  // UINT64_MAX without readers
+
+ private:
+  struct alignas(64) slot {
+    std::atomic<uint64_t> epoch{0};  // 0 while the slot is free
+  };
+
+  std::atomic<uint64_t> epoch_{1};
+  slot slots_[slot_count];
+};
+
+// The epoch is read again after the slot is claimed and the slot updated
+// until both agree. A writer that advanced the epoch after that read will
+// see the slot when it scans; one that advanced before it has its unlinks
+// visible to this reader, which therefore cannot reach what it retired.
+inline size_t ReaderEpochs::enter() noexcept {
+  thread_local size_t hint =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % slot_count;
+  for (size_t i = hint;; i = (i + 1) % slot_count) {
+    uint64_t free = 0;
+    uint64_t now = epoch_.load(std::memory_order_seq_cst);
+    if (slots_[i].epoch.compare_exchange_strong(free, now,
+                                                std::memory_order_seq_cst)) {
+      for (uint64_t again = epoch_.load(std::memory_order_seq_cst);
+           again != now; again = epoch_.load(std::memory_order_seq_cst)) {
+        now = again;
+        slots_[i].epoch.store(now, std::memory_order_seq_cst);
+      }
+      hint = i;
+      return i;
+    }
+  }
+}
+
+// Holds a slot for the lifetime of a read.
+class ReaderEpochs::Guard {
+ public:
+  explicit Guard(ReaderEpochs &epochs) noexcept
+      : epochs_(epochs), slot_(epochs.enter()) {}
+  Guard(const Guard &) = delete;
+  Guard &operator=(const Guard &) = delete;
+  ~Guard() { epochs_.leave(slot_); }
+
+ private:
+  ReaderEpochs &epochs_;
+  size_t slot_;
+};
+
+inline uint64_t ReaderEpochs::oldest_reader() const noexcept {
+  uint64_t oldest = UINT64_MAX;
+  for (const slot &s : slots_) {
+    uint64_t epoch = s.epoch.load(std::memory_order_seq_cst);
+    if (epoch != 0 && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+  return oldest;
+}
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef CPP2_S21_CONTAINERS_2_CONCURRENT_S21_CONCURRENT_MAP_H_
+#define CPP2_S21_CONTAINERS_2_CONCURRENT_S21_CONCURRENT_MAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../persistent/s21_persistent.h"
+#include "reader_epochs.h"
+
+namespace s21 {
+
+// Map for read-mostly workloads shared between threads. Lookups take no
+// lock and write no shared memory: they walk the current version of a
+// PersistentMap. Writers serialize on a mutex, path-copy the O(log n)
+// nodes they change into a new version and publish its root atomically,
+// so a reader sees either the old or the new version, never a mix.
+// Replaced versions are freed once every reader that could see them has
+// left; nodes shared with the new version stay alive through their
+// reference counts.
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class ConcurrentMap {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using size_type = size_t;
+  using snapshot_type = PersistentMap<Key, T, Compare>;
+
+  ConcurrentMap() = default;
+  explicit ConcurrentMap(const Compare &comp)
+      : comp_(comp), current_(comp) {}
+  ConcurrentMap(std::initializer_list<value_type> const &items)
+      : current_(items) {
+    root_.store(current_.root(), std::memory_order_seq_cst);
+    size_.store(current_.size(), std::memory_order_relaxed);
+  }
+  ConcurrentMap(const ConcurrentMap &) = delete;
+  ConcurrentMap &operator=(const ConcurrentMap &) = delete;
+
+  // Lock-free readers.
+  std::optional<T> find(const Key &key) const;
+  T at(const Key &key) const;
+  bool contains(const Key &key) const { return find(key).has_value(); }
+  snapshot_type snapshot() const;  // consistent view for iteration
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+  bool empty() const noexcept { return size() == 0; }
+
+  // Writers, serialized among themselves.
+  bool insert(const Key &key, const T &obj);
+  bool insert_or_assign(const Key &key, const T &obj);
+  size_type erase(const Key &key);
+  void clear();
+
+ private:
+  // Gives the map access to the nodes of the versions it manages.
+  class Version : public snapshot_type {
+   public:
+    using node = typename snapshot_type::node;
+    using snapshot_type::snapshot_type;
+    const node *root() const noexcept { return this->root_; }
+    static snapshot_type adopt(const node *root, const Compare &comp);
+    static const node *lookup(const node *root, const Key &key,
+                              const Compare &comp);
+  };
+  using node = typename Version::node;
+
+  std::atomic<const node *> root_{nullptr};
+  std::atomic<size_type> size_{0};
+  const Compare comp_ = Compare();
+  mutable ReaderEpochs readers_;
+  std::mutex writer_;
+  Version current_;  // owns the published root, guarded by writer_
+  std::vector<std::pair<uint64_t, Version>> retired_;
+
+  template <typename Edit>
+  auto write_(Edit edit);
+};
+
+template <typename Key, typename T, typename Compare>
+typename ConcurrentMap<Key, T, Compare>::snapshot_type
+ConcurrentMap<Key, T, Compare>::Version::adopt(const node *root,
+                                               const Compare &comp) {
+  Version version(comp);
+  version.root_ = snapshot_type::retain_(const_cast<node *>(root));
+  return version;
+}
+
+template <typename Key, typename T, typename Compare>
+const typename ConcurrentMap<Key, T, Compare>::Version::node *
+ConcurrentMap<Key, T, Compare>::Version::lookup(const node *root,
+                                                const Key &key,
+                                                const Compare &comp) {
+  while (root) {
+    if (compare_less(comp, key, root->value.first)) {
+      root = root->left;
+    } else if (compare_less(comp, root->value.first, key)) {
+      root = root->right;
+    } else {
+      return root;
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key, typename T, typename Compare>
+std::optional<T> ConcurrentMap<Key, T, Compare>::find(const Key &key) const {
+  ReaderEpochs::Guard guard(readers_);
+  const node *found =
+      Version::lookup(root_.load(std::memory_order_seq_cst), key, comp_);
+  if (found == nullptr) {
+    return std::nullopt;
+  }
+  return found->value.second;
+}
+
+template <typename Key, typename T, typename Compare>
+T ConcurrentMap<Key, T, Compare>::at(const Key &key) const {
+  std::optional<T> found = find(key);
+  if (!found) {
+    throw std::out_of_range("key not found");
+  }
+  return std::move(*found);
+}
+
+// Taking a reference pins the version for as long as the snapshot lives,
+// independently of the epochs.
+template <typename Key, typename T, typename Compare>
+typename ConcurrentMap<Key, T, Compare>::snapshot_type
+ConcurrentMap<Key, T, Compare>::snapshot() const {
+  ReaderEpochs::Guard guard(readers_);
+  return Version::adopt(root_.load(std::memory_order_seq_cst), comp_);
+}
+
+template <typename Key, typename T, typename Compare>
+bool ConcurrentMap<Key, T, Compare>::insert(const Key &key, const T &obj) {
+  return write_([&](Version &next) { return next.insert(key, obj).second; });
+}
+
+template <typename Key, typename T, typename Compare>
+bool ConcurrentMap<Key, T, Compare>::insert_or_assign(const Key &key,
+                                                      const T &obj) {
+  return write_(
+      [&](Version &next) { return next.insert_or_assign(key, obj).second; });
+}
+
+template <typename Key, typename T, typename Compare>
+typename ConcurrentMap<Key, T, Compare>::size_type
+ConcurrentMap<Key, T, Compare>::erase(const Key &key) {
+  return write_([&](Version &next) { return next.erase(key); });
+}
+
+template <typename Key, typename T, typename Compare>
+void ConcurrentMap<Key, T, Compare>::clear() {
+  write_([](Version &next) {
+    next.clear();
+    return true;
+  });
+}
+
+// The edit runs on a copy of the published version: its root is shared,
+// so every node the edit touches is copied and readers never see a node
+// change. The replaced version is retired, and retired versions older
+// than every active reader are released.
+template <typename Key, typename T, typename Compare>
+template <typename Edit>
+auto ConcurrentMap<Key, T, Compare>::write_(Edit edit) {
+  std::lock_guard<std::mutex> lock(writer_);
+  Version next = current_;
+  auto result = edit(next);
+  if (next.root() != current_.root()) {
+    root_.store(next.root(), std::memory_order_seq_cst);
+    size_.store(next.size(), std::memory_order_relaxed);
+    retired_.emplace_back(readers_.advance(), std::move(current_));
+    current_ = std::move(next);
+  }
+  uint64_t oldest = readers_.oldest_reader();
+  size_t kept = 0;
+  for (size_t i = 0; i < retired_.size(); i++) {
+    if (retired_[i].first > oldest) {
+      retired_[kept++] = std::move(retired_[i]);
+    }
+  }
+  retired_.erase(retired_.begin() + kept, retired_.end());
+  return result;
+}
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,582 @@
+#ifndef CPP2_S21_CONTAINERS_2_CONCURRENT_S21_SKIP_LIST_H_
+#define CPP2_S21_CONTAINERS_2_CONCURRENT_S21_SKIP_LIST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../binary_search_tree/binary_search_tree.h"
+#include "../btree/btree.h"
+#include "reader_epochs.h"
+
+namespace s21 {
+
+// Lock-free ordered set of unique keys shared between threads: a skip
+// list whose links carry a deletion mark in their low bit (Harris'
+// scheme, one list per level). insert, erase and contains never block;
+// a thread that finds a marked node on its way unlinks it.
+//
+// Erased nodes are retired to a lock-free list and freed once no thread
+// that may still hold a pointer to them remains inside an operation (see
+// ReaderEpochs). A node is retired by whichever of its inserter and its
+// eraser finishes last, since an inserter may still be linking the upper
+// levels of a node that is already being erased.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare = std::less<Key>>
+class LockFreeSkipList {
+ public:
+  class Iterator;
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+  static constexpr int max_level = 24;
+
+  LockFreeSkipList();
+  explicit LockFreeSkipList(const Compare &comp);
+  LockFreeSkipList(std::initializer_list<value_type> const &items);
+  LockFreeSkipList(const LockFreeSkipList &) = delete;
+  LockFreeSkipList &operator=(const LockFreeSkipList &) = delete;
+  ~LockFreeSkipList();
+
+  // Iteration is weakly consistent: it sees every value present for the
+  // whole walk and may or may not see concurrent changes. All iterators a
+  // thread holds on one list share a single reader slot, taken by the
+  // first of them, and nodes erased after that stay allocated until the
+  // last of them is destroyed or reaches end(); keep iterators short-lived
+  // under heavy erasure.
+  Iterator begin() const;
+  Iterator end() const noexcept { return Iterator(); }
+  bool empty() const noexcept { return size() == 0; }
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }  // exact when no operation is in flight
+  key_compare key_comp() const { return comp_; }
+
+  bool insert(const value_type &value);
+  size_type erase(const key_type &key);
+  bool contains(const key_type &key) const;
+
+ protected:
+  using link = std::atomic<uintptr_t>;
+  struct node {
+    explicit node(int levels) noexcept : height(levels) {}
+    const int height;
+    std::atomic<int> owners{2};  // inserter and eraser, see above
+    node *retired_next = nullptr;
+    uint64_t retired_epoch = 0;
+    alignas(Value) unsigned char storage[sizeof(Value)];
+    Value &value() noexcept {
+      return *std::launder(reinterpret_cast<Value *>(storage));
+    }
+    link *next() noexcept { return reinterpret_cast<link *>(this + 1); }
+  };
+
+  node *head_;
+  Compare comp_ = Compare();
+  std::atomic<size_type> size_{0};
+  std::atomic<node *> retired_{nullptr};
+  std::atomic<size_type> retired_count_{0};
+  mutable ReaderEpochs readers_;
+
+  static node *pointer_(uintptr_t link) noexcept {
+    return reinterpret_cast<node *>(link & ~uintptr_t(1));
+  }
+  static bool marked_(uintptr_t link) noexcept { return link & 1; }
+  static uintptr_t raw_(node *n) noexcept {
+    return reinterpret_cast<uintptr_t>(n);
+  }
+  bool less_(const key_type &a, const key_type &b) const {
+    return compare_less(comp_, a, b);
+  }
+  static const key_type &key_of_(node *n) noexcept {
+    return KeyOfValue()(n->value());
+  }
+  static node *new_node_(int levels, const Value *value);
+  static void free_node_(node *n, bool with_value) noexcept;
+  static int random_level_() noexcept;
+  node *first_live_(node *n) const noexcept;
+  std::shared_ptr<ReaderEpochs::Guard> shared_guard_() const;
+  bool find_(const key_type &key, node **preds, node **succs);
+  void link_upper_(node *n, node **preds, node **succs);
+  void disown_(node *n);
+  void retire_(node *n);
+  void reclaim_();
+  template <typename Predicate>
+  node *lookup_(const key_type &key, Predicate stop) const;
+};
+
+// Holds the reader epoch of its walk, so the nodes it visits stay
+// allocated however long the iterator lives.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+class LockFreeSkipList<Key, Value, KeyOfValue, Compare>::Iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Value *;
+  using reference = const Value &;
+
+  Iterator() noexcept = default;
+  reference operator*() const noexcept { return node_->value(); }
+  pointer operator->() const noexcept { return &node_->value(); }
+  Iterator &operator++() noexcept {
+    node_ = list_->first_live_(pointer_(node_->next()[0].load()));
+    if (node_ == nullptr) {
+      guard_.reset();
+    }
+    return *this;
+  }
+  Iterator operator++(int) noexcept {
+    Iterator old = *this;
+    ++*this;
+    return old;
+  }
+  bool operator==(const Iterator &other) const noexcept {
+    return node_ == other.node_;
+  }
+  bool operator!=(const Iterator &other) const noexcept {
+    return node_ != other.node_;
+  }
+
+ private:
+  friend class LockFreeSkipList;
+  Iterator(const LockFreeSkipList *list,
+           std::shared_ptr<ReaderEpochs::Guard> guard) noexcept
+      : list_(list), guard_(std::move(guard)) {}
+
+  const LockFreeSkipList *list_ = nullptr;
+  std::shared_ptr<ReaderEpochs::Guard> guard_;
+  node *node_ = nullptr;
+};
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::LockFreeSkipList()
+    : head_(new_node_(max_level, nullptr)) {}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::LockFreeSkipList(
+    const Compare &comp)
+    : head_(new_node_(max_level, nullptr)), comp_(comp) {}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::LockFreeSkipList(
+    std::initializer_list<value_type> const &items)
+    : LockFreeSkipList() {
+  for (const value_type &item : items) {
+    insert(item);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::~LockFreeSkipList() {
+  node *n = pointer_(head_->next()[0].load());
+  while (n) {
+    node *next = pointer_(n->next()[0].load());
+    free_node_(n, true);
+    n = next;
+  }
+  for (n = retired_.load(); n;) {
+    node *next = n->retired_next;
+    free_node_(n, true);
+    n = next;
+  }
+  free_node_(head_, false);
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename LockFreeSkipList<Key, Value, KeyOfValue, Compare>::node *
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::new_node_(
+    int levels, const Value *value) {
+  void *memory = ::operator new(sizeof(node) + levels * sizeof(link));
+  node *n = new (memory) node(levels);
+  for (int i = 0; i < levels; i++) {
+    new (n->next() + i) link(0);
+  }
+  if (value) {
+    try {
+      new (n->storage) Value(*value);
+    } catch (...) {
+      ::operator delete(memory);
+      throw;
+    }
+  }
+  return n;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void LockFreeSkipList<Key, Value, KeyOfValue, Compare>::free_node_(
+    node *n, bool with_value) noexcept {
+  if (with_value) {
+    n->value().~Value();
+  }
+  n->~node();
+  ::operator delete(n);
+}
+
+// Level k is reached with probability 2^-k, from a per-thread xorshift.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+int LockFreeSkipList<Key, Value, KeyOfValue, Compare>::random_level_()
+    noexcept {
+  thread_local uint64_t state =
+      0x9E3779B97F4A7C15ull ^
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  int level = 1;
+  for (uint64_t bits = state; (bits & 1) && level < max_level; bits >>= 1) {
+    level++;
+  }
+  return level;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename LockFreeSkipList<Key, Value, KeyOfValue, Compare>::node *
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::first_live_(
+    node *n) const noexcept {
+  while (n && marked_(n->next()[0].load(std::memory_order_acquire))) {
+    n = pointer_(n->next()[0].load(std::memory_order_acquire));
+  }
+  return n;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename LockFreeSkipList<Key, Value, KeyOfValue, Compare>::Iterator
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::begin() const {
+  Iterator it(this, shared_guard_());
+  it.node_ = first_live_(pointer_(head_->next()[0].load()));
+  if (it.node_ == nullptr) {
+    it.guard_.reset();
+  }
+  return it;
+}
+
+// Returns the guard this thread's live iterators on the list already
+// share, or a new one. Without the sharing every iterator would pin a slot
+// of its own and the slot_count + 1st live one would wait forever for a
+// free slot. Reusing an older guard is safe: it only keeps more retired
+// nodes allocated.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+std::shared_ptr<ReaderEpochs::Guard>
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::shared_guard_() const {
+  thread_local std::vector<
+      std::pair<const ReaderEpochs *, std::weak_ptr<ReaderEpochs::Guard>>>
+      guards;
+  std::shared_ptr<ReaderEpochs::Guard> guard;
+  for (size_t i = 0; i < guards.size();) {
+    if (guards[i].second.expired()) {
+      guards[i] = std::move(guards.back());
+      guards.pop_back();
+      continue;
+    }
+    if (guards[i].first == &readers_) {
+      guard = guards[i].second.lock();
+    }
+    i++;
+  }
+  if (guard == nullptr) {
+    guard = std::make_shared<ReaderEpochs::Guard>(readers_);
+    guards.emplace_back(&readers_, guard);
+  }
+  return guard;
+}
+
+// Fills preds/succs with the neighbours of key on every level, unlinking
+// marked nodes on the way, and reports whether succs[0] holds key.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+bool LockFreeSkipList<Key, Value, KeyOfValue, Compare>::find_(
+    const key_type &key, node **preds, node **succs) {
+retry:
+  node *pred = head_;
+  for (int level = max_level - 1; level >= 0; level--) {
+    node *curr = pointer_(pred->next()[level].load(std::memory_order_acquire));
+    while (curr) {
+      uintptr_t succ = curr->next()[level].load(std::memory_order_acquire);
+      while (marked_(succ)) {
+        uintptr_t expected = raw_(curr);
+        if (!pred->next()[level].compare_exchange_strong(
+                expected, succ & ~uintptr_t(1), std::memory_order_acq_rel)) {
+          goto retry;
+        }
+        curr = pointer_(succ);
+        if (curr == nullptr) {
+          break;
+        }
+        succ = curr->next()[level].load(std::memory_order_acquire);
+      }
+      if (curr == nullptr || !less_(key_of_(curr), key)) {
+        break;
+      }
+      pred = curr;
+      curr = pointer_(succ);
+    }
+    preds[level] = pred;
+    succs[level] = curr;
+  }
+  return succs[0] && !less_(key, key_of_(succs[0]));
+}
+
+// Read-only descent that steps over marked nodes instead of unlinking
+// them; returns the first live node for which stop holds at level 0.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+template <typename Predicate>
+typename LockFreeSkipList<Key, Value, KeyOfValue, Compare>::node *
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::lookup_(
+    const key_type &key, Predicate stop) const {
+  node *pred = head_;
+  node *curr = nullptr;
+  for (int level = max_level - 1; level >= 0; level--) {
+    curr = pointer_(pred->next()[level].load(std::memory_order_acquire));
+    while (curr) {
+      uintptr_t succ = curr->next()[level].load(std::memory_order_acquire);
+      if (marked_(succ)) {
+        curr = pointer_(succ);
+        continue;
+      }
+      if (stop(key_of_(curr), key)) {
+        break;
+      }
+      pred = curr;
+      curr = pointer_(succ);
+    }
+  }
+  return curr;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+bool LockFreeSkipList<Key, Value, KeyOfValue, Compare>::contains(
+    const key_type &key) const {
+  ReaderEpochs::Guard guard(readers_);
+  node *found = lookup_(key, [this](const key_type &a, const key_type &b) {
+    return !less_(a, b);
+  });
+  return found && !less_(key, key_of_(found));
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+bool LockFreeSkipList<Key, Value, KeyOfValue, Compare>::insert(
+    const value_type &value) {
+  const key_type &key = KeyOfValue()(value);
+  node *preds[max_level];
+  node *succs[max_level];
+  int levels = random_level_();
+  node *n = nullptr;
+  {
+    ReaderEpochs::Guard guard(readers_);
+    while (true) {
+      if (find_(key, preds, succs)) {
+        if (n) {
+          free_node_(n, true);
+        }
+        return false;
+      }
+      if (n == nullptr) {
+        n = new_node_(levels, &value);
+      }
+      for (int level = 0; level < levels; level++) {
+        n->next()[level].store(raw_(succs[level]), std::memory_order_relaxed);
+      }
+      uintptr_t expected = raw_(succs[0]);
+      if (preds[0]->next()[0].compare_exchange_strong(
+              expected, raw_(n), std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    link_upper_(n, preds, succs);
+  }
+  disown_(n);
+  return true;
+}
+
+// Links n on its upper levels, pointing it at fresh successors whenever a
+// level has to be retried, and stops as soon as n is marked for erasure.
+// If that happened, a final search unlinks whatever was linked late.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void LockFreeSkipList<Key, Value, KeyOfValue, Compare>::link_upper_(
+    node *n, node **preds, node **succs) {
+  const key_type &key = key_of_(n);
+  for (int level = 1; level < n->height; level++) {
+    while (true) {
+      uintptr_t own = n->next()[level].load(std::memory_order_acquire);
+      if (marked_(own)) {
+        find_(key, preds, succs);
+        return;
+      }
+      if (own != raw_(succs[level]) &&
+          !n->next()[level].compare_exchange_strong(
+              own, raw_(succs[level]), std::memory_order_acq_rel)) {
+        continue;
+      }
+      uintptr_t expected = raw_(succs[level]);
+      if (preds[level]->next()[level].compare_exchange_strong(
+              expected, raw_(n), std::memory_order_acq_rel)) {
+        break;
+      }
+      find_(key, preds, succs);
+      if (succs[0] != n) {
+        return;  // erased, and already unlinked from level 0
+      }
+    }
+  }
+  if (marked_(n->next()[0].load(std::memory_order_acquire))) {
+    find_(key, preds, succs);
+  }
+}
+
+// Marks every level top-down; whoever marks level 0 has erased the key.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename LockFreeSkipList<Key, Value, KeyOfValue, Compare>::size_type
+LockFreeSkipList<Key, Value, KeyOfValue, Compare>::erase(const key_type &key) {
+  node *preds[max_level];
+  node *succs[max_level];
+  node *victim = nullptr;
+  {
+    ReaderEpochs::Guard guard(readers_);
+    if (!find_(key, preds, succs)) {
+      return 0;
+    }
+    victim = succs[0];
+    for (int level = victim->height - 1; level > 0; level--) {
+      uintptr_t next = victim->next()[level].load(std::memory_order_acquire);
+      while (!marked_(next) &&
+             !victim->next()[level].compare_exchange_weak(
+                 next, next | 1, std::memory_order_acq_rel)) {
+      }
+    }
+    uintptr_t next = victim->next()[0].load(std::memory_order_acquire);
+    while (true) {
+      if (marked_(next)) {
+        return 0;  // another thread erased it first
+      }
+      if (victim->next()[0].compare_exchange_weak(
+              next, next | 1, std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    find_(key, preds, succs);
+  }
+  disown_(victim);
+  return 1;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void LockFreeSkipList<Key, Value, KeyOfValue, Compare>::disown_(node *n) {
+  if (n->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    retire_(n);
+  }
+}
+
+// Stamps n with an epoch no current reader has reached yet and pushes it
+// on the retired list; every 64 retirements the list is swept.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void LockFreeSkipList<Key, Value, KeyOfValue, Compare>::retire_(node *n) {
+  n->retired_epoch = readers_.advance();
+  n->retired_next = retired_.load(std::memory_order_relaxed);
+  while (!retired_.compare_exchange_weak(n->retired_next, n,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+  if (retired_count_.fetch_add(1, std::memory_order_relaxed) % 64 == 63) {
+    reclaim_();
+  }
+}
+
+// Takes the whole retired list, frees what no reader can reach and puts
+// the rest back.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void LockFreeSkipList<Key, Value, KeyOfValue, Compare>::reclaim_() {
+  node *list = retired_.exchange(nullptr, std::memory_order_acquire);
+  uint64_t oldest = readers_.oldest_reader();
+  node *kept = nullptr;
+  node *kept_tail = nullptr;
+  while (list) {
+    node *next = list->retired_next;
+    if (list->retired_epoch <= oldest) {
+      free_node_(list, true);
+    } else {
+      list->retired_next = kept;
+      kept = list;
+      if (kept_tail == nullptr) {
+        kept_tail = list;
+      }
+    }
+    list = next;
+  }
+  if (kept) {
+    kept_tail->retired_next = retired_.load(std::memory_order_relaxed);
+    while (!retired_.compare_exchange_weak(kept_tail->retired_next, kept,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+  }
+}
+
+// The S21Set surface over the skip list.
+template <typename T, typename Compare = std::less<T>>
+class ConcurrentSkipListSet
+    : public LockFreeSkipList<T, T, BTreeIdentity, Compare> {
+  using List = LockFreeSkipList<T, T, BTreeIdentity, Compare>;
+
+ public:
+  using List::List;
+};
+
+// The S21Map surface over the skip list. Entries are immutable once
+// inserted, so lookups return copies of the mapped value.
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class ConcurrentSkipListMap
+    : public LockFreeSkipList<Key, std::pair<Key, T>, BTreeSelectFirst,
+                              Compare> {
+  using List =
+      LockFreeSkipList<Key, std::pair<Key, T>, BTreeSelectFirst, Compare>;
+
+ public:
+  using mapped_type = T;
+  using typename List::value_type;
+  using List::insert;
+  using List::List;
+
+  bool insert(const Key &key, const T &obj) {
+    return insert(value_type(key, obj));
+  }  // inserts a value by key unless the key is already present
+  std::optional<T> find(const Key &key) const;
+  T at(const Key &key) const {
+    std::optional<T> found = find(key);
+    if (!found) {
+      throw std::out_of_range("key not found");
+    }
+    return std::move(*found);
+  }  // copy of the mapped value, with bounds checking
+};
+
+template <typename Key, typename T, typename Compare>
+std::optional<T> ConcurrentSkipListMap<Key, T, Compare>::find(
+    const Key &key) const {
+  ReaderEpochs::Guard guard(this->readers_);
+  auto *found =
+      this->lookup_(key, [this](const Key &a, const Key &b) {
+        return !this->less_(a, b);
+      });
+  if (found == nullptr || this->less_(key, found->value().first)) {
+    return std::nullopt;
+  }
+  return found->value().second;
+}
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+TEST(ConcurrentTests, SingleThreadedOperations) {
+  s21::ConcurrentMap<int, std::string> map = {{1, "one"}, {2, "two"}};
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.at(1), "one");
+  EXPECT_FALSE(map.find(3).has_value());
+  EXPECT_THROW(map.at(3), std::out_of_range);
+  EXPECT_TRUE(map.insert(3, "three"));
+  EXPECT_FALSE(map.insert(3, "drei"));
+  EXPECT_FALSE(map.insert_or_assign(3, "drei"));
+  EXPECT_EQ(*map.find(3), "drei");
+  s21::PersistentMap<int, std::string> view = map.snapshot();
+  EXPECT_EQ(map.erase(1), 1u);
+  EXPECT_EQ(map.erase(1), 0u);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_EQ(view.size(), 3u);
+  EXPECT_EQ(view.at(1), "one");
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(view.at(3), "drei");
+}
+
+// Writers only ever store key * 10 under key and append keys in order,
+// so a reader must never see another value and every snapshot must hold
+// a prefix of the keys.
+TEST(ConcurrentTests, ReadersSeeWholeVersions) {
+  constexpr int keys = 2000;
+  s21::ConcurrentMap<int, long> map;
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; r++) {
+    readers.emplace_back([&, r] {
+      while (!done.load()) {
+        for (int key = r; key < keys; key += 7) {
+          std::optional<long> value = map.find(key);
+          if (value && *value != key * 10L) {
+            errors++;
+          }
+        }
+        s21::PersistentMap<int, long> view = map.snapshot();
+        int expected = 0;
+        for (const auto &entry : view) {
+          if (entry.first != expected++) {
+            errors++;
+          }
+        }
+      }
+    });
+  }
+  std::thread writer([&] {
+    for (int key = 0; key < keys; key++) {
+      map.insert(key, key * 10L);
+      map.insert_or_assign(key, key * 10L);
+    }
+  });
+  writer.join();
+  done = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(map.size(), static_cast<size_t>(keys));
+  EXPECT_EQ(map.at(keys - 1), (keys - 1) * 10L);
+}
+
+TEST(ConcurrentTests, WritersSerialize) {
+  s21::ConcurrentMap<int, int> map;
+  std::vector<std::thread> writers;
+  for (int w = 0; w < 4; w++) {
+    writers.emplace_back([&map, w] {
+      for (int i = 0; i < 500; i++) {
+        map.insert(i * 4 + w, w);
+        if (i % 2) {
+          map.erase((i - 1) * 4 + w);
+        }
+      }
+    });
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(map.size(), 4u * 250);
+  EXPECT_EQ(map.snapshot().size(), 4u * 250);
+  EXPECT_EQ(map.at(499 * 4 + 2), 2);
+  EXPECT_FALSE(map.contains(498 * 4 + 2));
+}
+
+TEST(ConcurrentTests, SkipListSetSurface) {
+  s21::ConcurrentSkipListSet<int> set = {5, 1, 3};
+  EXPECT_EQ(set.size(), 3u);
+  EXPECT_FALSE(set.insert(3));
+  EXPECT_TRUE(set.insert(2));
+  EXPECT_TRUE(set.contains(2));
+  EXPECT_EQ(set.erase(5), 1u);
+  EXPECT_EQ(set.erase(5), 0u);
+  std::vector<int> items(set.begin(), set.end());
+  EXPECT_EQ(items, (std::vector<int>{1, 2, 3}));
+  s21::ConcurrentSkipListMap<std::string, int> map;
+  EXPECT_TRUE(map.insert("b", 2));
+  EXPECT_FALSE(map.insert("b", 3));
+  EXPECT_EQ(map.at("b"), 2);
+  EXPECT_FALSE(map.find("a").has_value());
+  EXPECT_THROW(map.at("a"), std::out_of_range);
+  for (const auto &entry : map) {
+    EXPECT_EQ(entry.first, "b");
+  }
+}
+
+// Live iterators of one thread share a reader slot, so holding more of
+// them than there are slots neither blocks begin() nor other operations.
+TEST(ConcurrentTests, SkipListIteratorsShareReaderSlot) {
+  s21::ConcurrentSkipListSet<int> set = {1, 2, 3};
+  s21::ConcurrentSkipListSet<int> other = {4};
+  std::vector<s21::ConcurrentSkipListSet<int>::iterator> iterators;
+  for (size_t i = 0; i < s21::ReaderEpochs::slot_count + 8; i++) {
+    iterators.push_back(set.begin());
+    iterators.push_back(other.begin());
+  }
+  EXPECT_EQ(*iterators.front(), 1);
+  EXPECT_EQ(*iterators.back(), 4);
+  EXPECT_TRUE(set.insert(0));
+  EXPECT_EQ(set.erase(2), 1u);
+  EXPECT_TRUE(set.contains(3));
+  EXPECT_EQ(*++iterators[2], 3);
+  iterators.clear();
+  std::vector<int> items(set.begin(), set.end());
+  EXPECT_EQ(items, (std::vector<int>{0, 1, 3}));
+}
+
+// Every key is inserted by several producers at once: exactly one of
+// them must win. Erasers then race over the same keys.
+TEST(ConcurrentTests, SkipListDeduplicatesAcrossThreads) {
+  constexpr int keys = 20000;
+  s21::ConcurrentSkipListSet<int> set;
+  std::atomic<int> inserted{0};
+  std::atomic<int> erased{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < keys; i++) {
+        int key = (i * 7 + t * 13) % keys;
+        inserted += set.insert(key) ? 1 : 0;
+        if (!set.contains(key)) {
+          inserted += 1000000;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(set.size(), static_cast<size_t>(keys));
+  threads.clear();
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t % 2; i < keys; i += 2) {
+        erased += static_cast<int>(set.erase(i));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(inserted.load(), keys);
+  EXPECT_EQ(erased.load(), keys);
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.begin() == set.end());
+}
+
+TEST(ConcurrentTests, SkipListChurnKeepsOrder) {
+  s21::ConcurrentSkipListSet<int> set;
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::thread reader([&] {
+    while (!done.load()) {
+      int previous = -1;
+      for (int value : set) {
+        if (value <= previous) {
+          errors++;
+        }
+        previous = value;
+      }
+    }
+  });
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 3; t++) {
+    writers.emplace_back([&set, t] {
+      std::mt19937 random(t);
+      for (int i = 0; i < 30000; i++) {
+        int key = random() % 512;
+        if (random() % 2) {
+          set.insert(key);
+        } else {
+          set.erase(key);
+        }
+      }
+    });
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(errors.load(), 0);
+  size_t count = 0;
+  for (auto it = set.begin(); it != set.end(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, set.size());
+}
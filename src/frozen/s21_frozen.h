@@ -0,0 +1,392 @@
+#ifndef CPP2_S21_CONTAINERS_2_FROZEN_S21_FROZEN_H_
+#define CPP2_S21_CONTAINERS_2_FROZEN_S21_FROZEN_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "../map/s21_map.h"
+#include "../set/s21_set.h"
+
+namespace s21 {
+
+constexpr size_t frozen_node_keys = 16;
+constexpr size_t frozen_alignment = 64;
+
+// Hands out cache-line aligned storage, so that a node of 16 four-byte
+// keys is exactly one cache line.
+template <typename T>
+struct CacheAlignedAllocator {
+  using value_type = T;
+  CacheAlignedAllocator() noexcept = default;
+  template <typename U>
+  CacheAlignedAllocator(const CacheAlignedAllocator<U> &) noexcept {}
+  T *allocate(size_t count) {
+    return static_cast<T *>(::operator new(
+        count * sizeof(T), std::align_val_t(frozen_alignment)));
+  }
+  void deallocate(T *memory, size_t) noexcept {
+    ::operator delete(memory, std::align_val_t(frozen_alignment));
+  }
+  template <typename U>
+  bool operator==(const CacheAlignedAllocator<U> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const CacheAlignedAllocator<U> &) const noexcept {
+    return false;
+  }
+};
+
+// Counts the keys of one node ordered before x (lower) or not after x
+// (upper). The loop has no data-dependent branch, so a node costs the same
+// whatever x is and compilers are free to vectorize it.
+template <typename Key, typename Compare, typename Enable = void>
+struct FrozenNodeSearch {
+  static size_t lower(const Key *node, const Key &x, const Compare &comp) {
+    size_t count = 0;
+    for (size_t i = 0; i < frozen_node_keys; i++) {
+      count += compare_less(comp, node[i], x) ? 1 : 0;
+    }
+    return count;
+  }
+  static size_t upper(const Key *node, const Key &x, const Compare &comp) {
+    size_t count = 0;
+    for (size_t i = 0; i < frozen_node_keys; i++) {
+      count += compare_less(comp, x, node[i]) ? 0 : 1;
+    }
+    return count;
+  }
+};
+
+#if defined(__SSE2__)
+// 32-bit integral keys under std::less: four SSE2 compares per node.
+// Unsigned keys are shifted into signed order by flipping the sign bit.
+template <typename Key>
+struct FrozenNodeSearch<
+    Key, std::less<Key>,
+    typename std::enable_if<std::is_integral<Key>::value &&
+                            sizeof(Key) == 4>::type> {
+  static __m128i bias() {
+    return _mm_set1_epi32(std::is_signed<Key>::value ? 0 : INT32_MIN);
+  }
+  static int greater_mask(const Key *node, __m128i x) {
+    int mask = 0;
+    for (int i = 0; i < 4; i++) {
+      __m128i keys = _mm_xor_si128(
+          _mm_load_si128(reinterpret_cast<const __m128i *>(node) + i),
+          bias());
+      mask |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, keys)))
+              << (4 * i);
+    }
+    return mask;
+  }
+  static size_t lower(const Key *node, const Key &x, const std::less<Key> &) {
+    __m128i probe =
+        _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(x)), bias());
+    return __builtin_popcount(greater_mask(node, probe));
+  }
+  static size_t upper(const Key *node, const Key &x, const std::less<Key> &) {
+    if (x == std::numeric_limits<Key>::max()) {
+      return frozen_node_keys;
+    }
+    return lower(node, static_cast<Key>(x + 1), std::less<Key>());
+  }
+};
+#endif
+
+#if defined(__SSE4_2__)
+// 64-bit integral keys under std::less, with SSE4.2 64-bit compares.
+template <typename Key>
+struct FrozenNodeSearch<
+    Key, std::less<Key>,
+    typename std::enable_if<std::is_integral<Key>::value &&
+                            sizeof(Key) == 8>::type> {
+  static __m128i bias() {
+    return _mm_set1_epi64x(std::is_signed<Key>::value ? 0 : INT64_MIN);
+  }
+  static size_t lower(const Key *node, const Key &x, const std::less<Key> &) {
+    __m128i probe =
+        _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(x)), bias());
+    int mask = 0;
+    for (int i = 0; i < 8; i++) {
+      __m128i keys = _mm_xor_si128(
+          _mm_load_si128(reinterpret_cast<const __m128i *>(node) + i),
+          bias());
+      mask |= _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(probe, keys)))
+              << (2 * i);
+    }
+    return __builtin_popcount(mask);
+  }
+  static size_t upper(const Key *node, const Key &x, const std::less<Key> &) {
+    if (x == std::numeric_limits<Key>::max()) {
+      return frozen_node_keys;
+    }
+    return lower(node, static_cast<Key>(x + 1), std::less<Key>());
+  }
+};
+#endif
+
+// Read-only search structure over a sorted run of unique keys: a static
+// B+ tree with 16 keys per node and 17 children per inner node, stored
+// level by level without pointers. The leaf level is the sorted key array
+// itself (padded with copies of the last key), so a search ends on a
+// position in sorted order after log17(n) node visits, one or two cache
+// lines each.
+template <typename Key, typename Compare = std::less<Key>>
+class FrozenIndex {
+ public:
+  using size_type = size_t;
+
+  FrozenIndex() = default;
+  explicit FrozenIndex(const Compare &comp) : comp_(comp) {}
+  template <typename InputIt>
+  void build(InputIt first, InputIt last);
+
+  size_type size() const noexcept { return size_; }
+  const Key *keys() const noexcept { return leaves_.data(); }
+  const Compare &key_comp() const noexcept { return comp_; }
+  size_type lower_index(const Key &x) const;
+  size_type upper_index(const Key &x) const;
+
+ private:
+  using Buffer = std::vector<Key, CacheAlignedAllocator<Key>>;
+  using Search = FrozenNodeSearch<Key, Compare>;
+
+  Buffer leaves_;
+  Buffer inner_;                     // inner levels, root level first
+  std::vector<size_type> offsets_;   // start of each inner level in inner_
+  size_type size_ = 0;
+  Compare comp_ = Compare();
+
+  template <bool Upper>
+  size_type search_(const Key &x) const;
+};
+
+template <typename Key, typename Compare>
+template <typename InputIt>
+void FrozenIndex<Key, Compare>::build(InputIt first, InputIt last) {
+  Buffer leaves(first, last);
+  for (size_type i = 1; i < leaves.size(); i++) {
+    if (!compare_less(comp_, leaves[i - 1], leaves[i])) {
+      throw std::invalid_argument("keys are not sorted and unique");
+    }
+  }
+  size_type count = leaves.size();
+  std::vector<size_type> level_nodes;
+  if (count > 0) {
+    level_nodes.push_back((count + frozen_node_keys - 1) / frozen_node_keys);
+    leaves.resize(level_nodes[0] * frozen_node_keys, leaves[count - 1]);
+  }
+  while (!level_nodes.empty() && level_nodes.back() > 1) {
+    level_nodes.push_back((level_nodes.back() + frozen_node_keys) /
+                          (frozen_node_keys + 1));
+  }
+  // Key j of inner node k separates children j and j + 1: it is the
+  // first key under child j + 1, or the last key when that child does
+  // not exist.
+  Buffer inner;
+  size_type span = 1;  // leaves under one node of the level below
+  for (size_type level = 1; level < level_nodes.size(); level++) {
+    span *= level == 1 ? 1 : frozen_node_keys + 1;
+    Buffer keys;
+    keys.reserve(level_nodes[level] * frozen_node_keys + inner.size());
+    for (size_type k = 0; k < level_nodes[level]; k++) {
+      for (size_type j = 0; j < frozen_node_keys; j++) {
+        size_type child = k * (frozen_node_keys + 1) + j + 1;
+        size_type first_leaf = child * span * frozen_node_keys;
+        keys.push_back(first_leaf < count ? leaves[first_leaf]
+                                          : leaves[count - 1]);
+      }
+    }
+    keys.insert(keys.end(), inner.begin(), inner.end());
+    inner.swap(keys);
+  }
+  std::vector<size_type> offsets;
+  size_type offset = 0;
+  for (size_type level = level_nodes.size(); level-- > 1;) {
+    offsets.push_back(offset);
+    offset += level_nodes[level] * frozen_node_keys;
+  }
+  leaves_.swap(leaves);
+  inner_.swap(inner);
+  offsets_.swap(offsets);
+  size_ = count;
+}
+
+// A key past the last one is rejected up front; after that every counted
+// separator belongs to an existing child and the leaf position is exact.
+template <typename Key, typename Compare>
+template <bool Upper>
+typename FrozenIndex<Key, Compare>::size_type
+FrozenIndex<Key, Compare>::search_(const Key &x) const {
+  if (size_ == 0) {
+    return 0;
+  }
+  const Key &back = leaves_[size_ - 1];
+  if (Upper ? !compare_less(comp_, x, back) : compare_less(comp_, back, x)) {
+    return size_;
+  }
+  size_type node = 0;
+  for (size_type offset : offsets_) {
+    const Key *keys = inner_.data() + offset + node * frozen_node_keys;
+    size_type child = Upper ? Search::upper(keys, x, comp_)
+                            : Search::lower(keys, x, comp_);
+    node = node * (frozen_node_keys + 1) + child;
+  }
+  const Key *keys = leaves_.data() + node * frozen_node_keys;
+  return node * frozen_node_keys +
+         (Upper ? Search::upper(keys, x, comp_)
+                : Search::lower(keys, x, comp_));
+}
+
+template <typename Key, typename Compare>
+typename FrozenIndex<Key, Compare>::size_type
+FrozenIndex<Key, Compare>::lower_index(const Key &x) const {
+  return search_<false>(x);
+}
+
+template <typename Key, typename Compare>
+typename FrozenIndex<Key, Compare>::size_type
+FrozenIndex<Key, Compare>::upper_index(const Key &x) const {
+  return search_<true>(x);
+}
+
+// Immutable sorted set with the lookup interface of S21Set. Iterators are
+// plain pointers into the sorted keys.
+template <typename T, typename Compare = std::less<T>>
+class FrozenSet {
+ public:
+  using value_type = T;
+  using key_compare = Compare;
+  using size_type = size_t;
+  using iterator = const T *;
+  using const_iterator = const T *;
+
+  FrozenSet() = default;
+  explicit FrozenSet(const S21Set<T, Compare> &set)
+      : index_(set.value_comp()) {
+    index_.build(set.begin(), set.end());
+  }  // copies a set into the frozen layout
+  template <typename InputIt>
+  FrozenSet(InputIt first, InputIt last,
+            const Compare &comp = Compare())
+      : index_(comp) {
+    index_.build(first, last);
+  }  // freezes a sorted range of unique values
+
+  iterator begin() const noexcept { return index_.keys(); }
+  iterator end() const noexcept { return index_.keys() + index_.size(); }
+  size_type size() const noexcept { return index_.size(); }
+  bool empty() const noexcept { return index_.size() == 0; }
+  key_compare key_comp() const { return index_.key_comp(); }
+
+  iterator lower_bound(const T &key) const {
+    return begin() + index_.lower_index(key);
+  }  // first element not less than key
+  iterator upper_bound(const T &key) const {
+    return begin() + index_.upper_index(key);
+  }  // first element greater than key
+  iterator find(const T &key) const {
+    iterator it = lower_bound(key);
+    if (it == end() || compare_less(index_.key_comp(), key, *it)) {
+      return end();
+    }
+    return it;
+  }  // element equal to key, or end()
+  bool contains(const T &key) const { return find(key) != end(); }
+  size_type count(const T &key) const { return contains(key) ? 1 : 0; }
+
+ private:
+  FrozenIndex<T, Compare> index_;
+};
+
+// Immutable sorted map with the lookup interface of S21Map. Keys are
+// indexed separately from the entries, so a lookup never touches mapped
+// values until it has found its position.
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class FrozenMap {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using key_compare = Compare;
+  using size_type = size_t;
+  using iterator = const value_type *;
+  using const_iterator = const value_type *;
+
+  FrozenMap() = default;
+  explicit FrozenMap(const S21Map<Key, T, Compare> &map)
+      : index_(map.key_comp()) {
+    std::vector<Key> keys;
+    keys.reserve(map.size());
+    entries_.reserve(map.size());
+    for (auto it = map.begin(); it != map.end(); ++it) {
+      keys.push_back((*it).first);
+      entries_.push_back(*it);
+    }
+    index_.build(keys.begin(), keys.end());
+  }  // copies a map into the frozen layout
+
+  iterator begin() const noexcept { return entries_.data(); }
+  iterator end() const noexcept { return entries_.data() + entries_.size(); }
+  size_type size() const noexcept { return entries_.size(); }
+  bool empty() const noexcept { return entries_.empty(); }
+  key_compare key_comp() const { return index_.key_comp(); }
+
+  iterator lower_bound(const Key &key) const {
+    return begin() + index_.lower_index(key);
+  }  // first entry whose key is not less than key
+  iterator upper_bound(const Key &key) const {
+    return begin() + index_.upper_index(key);
+  }  // first entry whose key is greater than key
+  iterator find(const Key &key) const {
+    size_type i = index_.lower_index(key);
+    if (i == size() ||
+        compare_less(index_.key_comp(), key, index_.keys()[i])) {
+      return end();
+    }
+    return begin() + i;
+  }  // entry with key, or end()
+  bool contains(const Key &key) const { return find(key) != end(); }
+  size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+  const T &at(const Key &key) const {
+    iterator it = find(key);
+    if (it == end()) {
+      throw std::out_of_range("key not found");
+    }
+    return it->second;
+  }  // mapped value of key, with bounds checking
+
+ private:
+  FrozenIndex<Key, Compare> index_;
+  std::vector<value_type> entries_;
+};
+
+template <typename T, typename Compare>
+FrozenSet<T, Compare> freeze(const S21Set<T, Compare> &set) {
+  return FrozenSet<T, Compare>(set);
+}
+
+template <typename Key, typename T, typename Compare>
+FrozenMap<Key, T, Compare> freeze(const S21Map<Key, T, Compare> &map) {
+  return FrozenMap<Key, T, Compare>(map);
+}
+
+}  // namespace s21
+
+#endif
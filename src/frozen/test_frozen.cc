@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+// reference is sorted by comp and free of duplicates.
+template <typename Frozen, typename Key, typename Compare = std::less<Key>>
+void ExpectSameLookups(const Frozen &frozen, const std::vector<Key> &reference,
+                       const Key &key, Compare comp = Compare()) {
+  auto lower = std::lower_bound(reference.begin(), reference.end(), key, comp);
+  auto upper = std::upper_bound(reference.begin(), reference.end(), key, comp);
+  ASSERT_EQ(frozen.lower_bound(key) - frozen.begin(),
+            lower - reference.begin());
+  ASSERT_EQ(frozen.upper_bound(key) - frozen.begin(),
+            upper - reference.begin());
+  ASSERT_EQ(frozen.contains(key), lower != upper);
+}
+
+template <typename T>
+void CheckIntegralKeys() {
+  std::mt19937_64 random(7);
+  for (size_t size : {0, 1, 15, 16, 17, 272, 273, 5000, 70000}) {
+    std::set<T> distinct;
+    s21::S21Set<T> set;
+    distinct.insert(std::numeric_limits<T>::min());
+    while (distinct.size() < size) {
+      distinct.insert(static_cast<T>(random()));
+    }
+    if (size == 0) {
+      distinct.clear();
+    }
+    for (const T &value : distinct) {
+      set.insert(value);
+    }
+    std::vector<T> reference(distinct.begin(), distinct.end());
+    s21::FrozenSet<T> frozen = s21::freeze(set);
+    ASSERT_EQ(frozen.size(), reference.size());
+    ASSERT_TRUE(std::equal(frozen.begin(), frozen.end(), reference.begin()));
+    ExpectSameLookups(frozen, reference, std::numeric_limits<T>::min());
+    ExpectSameLookups(frozen, reference, std::numeric_limits<T>::max());
+    // Present keys and their successors, spread over the whole range.
+    size_t step = reference.size() / 1000 + 1;
+    for (size_t i = 0; i < reference.size(); i += step) {
+      ExpectSameLookups(frozen, reference, reference[i]);
+      ExpectSameLookups(frozen, reference, static_cast<T>(reference[i] + 1));
+    }
+    for (int i = 0; i < 2000; i++) {
+      ExpectSameLookups(frozen, reference, static_cast<T>(random()));
+    }
+  }
+}
+
+TEST(FrozenTests, IntegralKeysMatchOrderedSet) {
+  CheckIntegralKeys<int>();
+  CheckIntegralKeys<uint32_t>();
+  CheckIntegralKeys<int64_t>();
+  CheckIntegralKeys<uint64_t>();
+}
+
+TEST(FrozenTests, GenericKeysAndComparator) {
+  std::set<std::string, std::greater<std::string>> reference;
+  s21::S21Set<std::string, std::greater<std::string>> set;
+  for (int i = 0; i < 3000; i += 3) {
+    reference.insert(std::to_string(i));
+    set.insert(std::to_string(i));
+  }
+  auto frozen = s21::freeze(set);
+  ASSERT_TRUE(std::equal(frozen.begin(), frozen.end(), reference.begin()));
+  std::vector<std::string> sorted(reference.begin(), reference.end());
+  for (int i = -5; i < 3005; i++) {
+    ExpectSameLookups(frozen, sorted, std::to_string(i),
+                      std::greater<std::string>());
+  }
+  EXPECT_EQ(*frozen.find("999"), "999");
+  EXPECT_EQ(frozen.find("1000"), frozen.end());
+}
+
+TEST(FrozenTests, MapLookups) {
+  s21::S21Map<int, std::string> map;
+  for (int i = 0; i < 1000; i++) {
+    map.insert(i * 2, std::to_string(i));
+  }
+  s21::FrozenMap<int, std::string> frozen = s21::freeze(map);
+  ASSERT_EQ(frozen.size(), 1000u);
+  EXPECT_EQ(frozen.at(500), "250");
+  EXPECT_THROW(frozen.at(501), std::out_of_range);
+  EXPECT_EQ(frozen.find(501), frozen.end());
+  EXPECT_EQ(frozen.lower_bound(501)->first, 502);
+  EXPECT_EQ(frozen.upper_bound(502)->first, 504);
+  EXPECT_EQ(frozen.lower_bound(1999), frozen.end());
+  EXPECT_TRUE(frozen.contains(0));
+  EXPECT_EQ(frozen.count(3), 0u);
+  int expected = 0;
+  for (const auto &entry : frozen) {
+    EXPECT_EQ(entry.first, expected);
+    expected += 2;
+  }
+}
+
+TEST(FrozenTests, RangeMustBeSortedAndUnique) {
+  std::vector<int> sorted = {1, 2, 3};
+  std::vector<int> duplicated = {1, 2, 2};
+  EXPECT_NO_THROW(s21::FrozenSet<int>(sorted.begin(), sorted.end()));
+  EXPECT_THROW(s21::FrozenSet<int>(duplicated.begin(), duplicated.end()),
+               std::invalid_argument);
+  s21::FrozenSet<int> empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_FALSE(empty.contains(0));
+  EXPECT_EQ(empty.lower_bound(0), empty.end());
+}
@@ -0,0 +1,360 @@
+#ifndef CPP2_S21_CONTAINERS_2_INTERVAL_S21_INTERVAL_H_
+#define CPP2_S21_CONTAINERS_2_INTERVAL_S21_INTERVAL_H_
+
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../binary_search_tree/binary_search_tree.h"
+
+namespace s21 {
+
+// Orders half-open intervals [start, end) by start, then by end.
+template <typename Point, typename Compare, typename KeyOfInterval>
+struct IntervalOrder {
+  Compare point_compare = Compare();
+  template <typename V>
+  bool operator()(const V &a, const V &b) const {
+    const auto &x = KeyOfInterval()(a);
+    const auto &y = KeyOfInterval()(b);
+    if (compare_less(point_compare, x.first, y.first)) {
+      return true;
+    }
+    if (compare_less(point_compare, y.first, x.first)) {
+      return false;
+    }
+    return compare_less(point_compare, x.second, y.second);
+  }
+};
+
+// Keeps the largest end point of every subtree, which tells a query
+// whether anything below a node can still reach its lower bound. Ends are
+// compared with a default-constructed Compare.
+template <typename Point, typename Compare, typename KeyOfInterval>
+struct MaxEndAugment {
+  using summary_type = std::optional<Point>;
+  static summary_type identity() { return std::nullopt; }
+  template <typename V>
+  static summary_type summarize(const V &value) {
+    return KeyOfInterval()(value).second;
+  }
+  static summary_type combine(const summary_type &left,
+                              const summary_type &right) {
+    if (!left || (right && compare_less(Compare(), *left, *right))) {
+      return right;
+    }
+    return left;
+  }
+};
+
+// BinarySearchTree of intervals ordered by start, augmented with the
+// largest end of each subtree. An overlap query walks the start order,
+// skipping every subtree whose intervals all end before the query begins
+// and stopping at the first start past its end. A query reporting k
+// intervals costs O(log n + k log(n / k)), which is O(log n + k) when the
+// matches are neighbours in start order.
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare = std::less<Point>>
+class IntervalTree
+    : public BinarySearchTree<Value,
+                              IntervalOrder<Point, Compare, KeyOfInterval>,
+                              MaxEndAugment<Point, Compare, KeyOfInterval>> {
+  using Tree =
+      BinarySearchTree<Value, IntervalOrder<Point, Compare, KeyOfInterval>,
+                       MaxEndAugment<Point, Compare, KeyOfInterval>>;
+
+ public:
+  using point_type = Point;
+  using interval_type = std::pair<Point, Point>;
+  using value_type = Value;
+  using size_type = typename Tree::size_type;
+  using iterator = typename Tree::iterator;
+  using const_iterator = typename Tree::ConstIterator;
+
+  IntervalTree() = default;
+  explicit IntervalTree(const Compare &comp) noexcept
+      : Tree(IntervalOrder<Point, Compare, KeyOfInterval>{comp}) {}
+
+  template <typename Fn>
+  void for_each_overlapping(const Point &point,
+                            Fn fn) const;  // intervals containing point
+  template <typename Fn>
+  void for_each_overlapping(const Point &low, const Point &high,
+                            Fn fn) const;  // intervals meeting [low, high)
+  std::vector<iterator> overlapping(const Point &point)
+      const;  // every interval containing point, in start order
+  std::vector<iterator> overlapping(const Point &low, const Point &high)
+      const;  // every interval overlapping [low, high), in start order
+  template <typename ForwardIt>
+  void load_sorted(ForwardIt first,
+                   ForwardIt last);  // O(n) bulk build from sorted input
+  template <typename InputIt>
+  void load(InputIt first,
+            InputIt last);  // sorts a range and replaces the contents
+
+ protected:
+  using node = typename Tree::node;
+  bool point_less_(const Point &a, const Point &b) const {
+    return compare_less(this->comp_.point_compare, a, b);
+  }
+  void check_(const interval_type &interval) const;
+  template <typename StartsInRange, typename Visit>
+  void visit_(node *t, const Point &low, const StartsInRange &starts_in_range,
+              Visit &visit) const;
+};
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::check_(
+    const interval_type &interval) const {
+  if (point_less_(interval.second, interval.first)) {
+    throw std::invalid_argument("interval ends before it starts");
+  }
+}
+
+// In-order walk over the intervals ending after low. Starts only grow to
+// the right, so once a node starts out of range its right subtree is
+// skipped too.
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+template <typename StartsInRange, typename Visit>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::visit_(
+    node *t, const Point &low, const StartsInRange &starts_in_range,
+    Visit &visit) const {
+  while (t && point_less_(low, *t->summary)) {
+    visit_(t->left, low, starts_in_range, visit);
+    const interval_type &interval = KeyOfInterval()(t->info);
+    if (!starts_in_range(interval.first)) {
+      return;
+    }
+    if (point_less_(low, interval.second)) {
+      visit(t);
+    }
+    t = t->right;
+  }
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+template <typename Fn>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::for_each_overlapping(
+    const Point &point, Fn fn) const {
+  auto starts_in_range = [this, &point](const Point &start) {
+    return !point_less_(point, start);
+  };
+  auto visit = [&fn](node *n) {
+    const value_type &value = n->info;
+    fn(value);
+  };
+  visit_(this->root_, point, starts_in_range, visit);
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+template <typename Fn>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::for_each_overlapping(
+    const Point &low, const Point &high, Fn fn) const {
+  if (!point_less_(low, high)) {
+    return;
+  }
+  auto starts_in_range = [this, &high](const Point &start) {
+    return point_less_(start, high);
+  };
+  auto visit = [&fn](node *n) {
+    const value_type &value = n->info;
+    fn(value);
+  };
+  visit_(this->root_, low, starts_in_range, visit);
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+std::vector<typename IntervalTree<Point, Value, KeyOfInterval,
+                                  Compare>::iterator>
+IntervalTree<Point, Value, KeyOfInterval, Compare>::overlapping(
+    const Point &point) const {
+  std::vector<iterator> found;
+  auto starts_in_range = [this, &point](const Point &start) {
+    return !point_less_(point, start);
+  };
+  auto visit = [this, &found](node *n) {
+    found.push_back(iterator(this, n));
+  };
+  visit_(this->root_, point, starts_in_range, visit);
+  return found;
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+std::vector<typename IntervalTree<Point, Value, KeyOfInterval,
+                                  Compare>::iterator>
+IntervalTree<Point, Value, KeyOfInterval, Compare>::overlapping(
+    const Point &low, const Point &high) const {
+  std::vector<iterator> found;
+  if (!point_less_(low, high)) {
+    return found;
+  }
+  auto starts_in_range = [this, &high](const Point &start) {
+    return point_less_(start, high);
+  };
+  auto visit = [this, &found](node *n) {
+    found.push_back(iterator(this, n));
+  };
+  visit_(this->root_, low, starts_in_range, visit);
+  return found;
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+template <typename ForwardIt>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::load_sorted(
+    ForwardIt first, ForwardIt last) {
+  for (ForwardIt it = first; it != last; ++it) {
+    check_(KeyOfInterval()(*it));
+  }
+  Tree::load_sorted(first, last);
+}
+
+template <typename Point, typename Value, typename KeyOfInterval,
+          typename Compare>
+template <typename InputIt>
+void IntervalTree<Point, Value, KeyOfInterval, Compare>::load(InputIt first,
+                                                              InputIt last) {
+  std::vector<value_type> items(first, last);
+  for (const value_type &item : items) {
+    check_(KeyOfInterval()(item));
+  }
+  Tree::load(items.begin(), items.end());
+}
+
+// Set of distinct half-open intervals [start, end) of Points.
+template <typename Point, typename Compare = std::less<Point>>
+class S21IntervalSet : public IntervalTree<Point, std::pair<Point, Point>,
+                                           ProjectValue, Compare> {
+  using Tree =
+      IntervalTree<Point, std::pair<Point, Point>, ProjectValue, Compare>;
+
+ public:
+  using typename Tree::interval_type;
+  using typename Tree::iterator;
+  using Tree::Tree;
+  S21IntervalSet(std::initializer_list<interval_type> const &items) {
+    this->load(items.begin(), items.end());
+  }  // throws std::invalid_argument for an interval ending before its start
+
+  std::pair<iterator, bool> insert(const interval_type &interval) {
+    this->check_(interval);
+    return this->insert_unique_(interval);
+  }  // inserts an interval unless it is already present
+  std::pair<iterator, bool> insert(const Point &start, const Point &end) {
+    return insert(interval_type(start, end));
+  }  // inserts [start, end) unless it is already present
+};
+
+// Map from distinct half-open intervals [start, end) to values.
+template <typename Point, typename T, typename Compare = std::less<Point>>
+class S21IntervalMap
+    : public IntervalTree<Point, std::pair<std::pair<Point, Point>, T>,
+                          ProjectKey, Compare> {
+  using Tree = IntervalTree<Point, std::pair<std::pair<Point, Point>, T>,
+                            ProjectKey, Compare>;
+
+ public:
+  using typename Tree::interval_type;
+  using typename Tree::iterator;
+  using typename Tree::value_type;
+  using mapped_type = T;
+  using node = typename Tree::node;
+  using Tree::Tree;
+  S21IntervalMap(std::initializer_list<value_type> const &items) {
+    this->load(items.begin(), items.end());
+  }  // throws std::invalid_argument for an interval ending before its start
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return insert(value.first.first, value.first.second, value.second);
+  }  // inserts an entry unless its interval is already present
+  std::pair<iterator, bool> insert(const Point &start, const Point &end,
+                                   const T &obj);  // maps [start, end) to obj
+                                                   // unless the interval is
+                                                   // already present
+  std::pair<iterator, bool> insert_or_assign(
+      const Point &start, const Point &end,
+      const T &obj);  // maps [start, end) to obj, replacing any value it had
+  T &at(const Point &start,
+        const Point &end);  // access the value of an interval with bounds
+                            // checking
+  bool contains(const Point &start, const Point &end)
+      const;  // checks whether the interval [start, end) is present
+
+ private:
+  using slot_ = typename Tree::slot_;
+  slot_ find_interval_slot_(const interval_type &interval) const;
+  static const interval_type &interval_of_(
+      const interval_type &interval) noexcept {
+    return interval;
+  }
+  static const interval_type &interval_of_(const value_type &entry) noexcept {
+    return entry.first;
+  }
+};
+
+// Descends by interval alone, so lookups never build a mapped value.
+template <typename Point, typename T, typename Compare>
+typename S21IntervalMap<Point, T, Compare>::slot_
+S21IntervalMap<Point, T, Compare>::find_interval_slot_(
+    const interval_type &interval) const {
+  IntervalOrder<Point, Compare, ProjectValue> order{
+      this->comp_.point_compare};
+  return this->find_slot_(interval, [&order](const auto &a, const auto &b) {
+    return order(interval_of_(a), interval_of_(b));
+  });
+}
+
+template <typename Point, typename T, typename Compare>
+std::pair<typename S21IntervalMap<Point, T, Compare>::iterator, bool>
+S21IntervalMap<Point, T, Compare>::insert(const Point &start,
+                                          const Point &end, const T &obj) {
+  interval_type interval(start, end);
+  this->check_(interval);
+  slot_ slot = find_interval_slot_(interval);
+  if (slot.found()) {
+    return std::make_pair(this->iterator_at_(slot), false);
+  }
+  node *entry = this->emplace_node_(interval, obj);
+  return std::make_pair(this->link_at_(slot, entry), true);
+}
+
+template <typename Point, typename T, typename Compare>
+std::pair<typename S21IntervalMap<Point, T, Compare>::iterator, bool>
+S21IntervalMap<Point, T, Compare>::insert_or_assign(const Point &start,
+                                                    const Point &end,
+                                                    const T &obj) {
+  std::pair<iterator, bool> result = insert(start, end, obj);
+  if (!result.second) {
+    result.first->second = obj;
+  }
+  return result;
+}
+
+template <typename Point, typename T, typename Compare>
+T &S21IntervalMap<Point, T, Compare>::at(const Point &start,
+                                         const Point &end) {
+  slot_ slot = find_interval_slot_(interval_type(start, end));
+  if (!slot.found()) {
+    throw std::out_of_range("no such interval in map");
+  }
+  return slot.parent->info.second;
+}
+
+template <typename Point, typename T, typename Compare>
+bool S21IntervalMap<Point, T, Compare>::contains(const Point &start,
+                                                 const Point &end) const {
+  return find_interval_slot_(interval_type(start, end)).found();
+}
+
+}  // namespace s21
+
+#endif
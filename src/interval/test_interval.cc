@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+using Interval = std::pair<int, int>;
+
+std::vector<Interval> Collect(const s21::S21IntervalSet<int> &set, int low,
+                              int high) {
+  std::vector<Interval> found;
+  for (auto it : set.overlapping(low, high)) {
+    found.push_back(*it);
+  }
+  return found;
+}
+
+TEST(IntervalTests, StabbingAndOverlapQueries) {
+  s21::S21IntervalSet<int> set = {{1, 5}, {3, 4}, {6, 9}, {2, 2}, {8, 12}};
+  EXPECT_EQ(set.size(), 5U);
+  std::vector<Interval> found;
+  set.for_each_overlapping(
+      3, [&found](const Interval &interval) { found.push_back(interval); });
+  EXPECT_EQ(found, (std::vector<Interval>{{1, 5}, {3, 4}}));
+  EXPECT_TRUE(set.overlapping(5).empty());
+  EXPECT_TRUE(set.overlapping(2, 2).empty());
+  EXPECT_EQ(Collect(set, 4, 7), (std::vector<Interval>{{1, 5}, {6, 9}}));
+  EXPECT_EQ(Collect(set, 9, 100), (std::vector<Interval>{{8, 12}}));
+  auto hits = set.overlapping(8);
+  ASSERT_EQ(hits.size(), 2U);
+  EXPECT_EQ(hits[1] - set.begin(), 4);
+  EXPECT_FALSE(set.insert(3, 4).second);
+  EXPECT_THROW(set.insert(4, 3), std::invalid_argument);
+  set.erase(hits[0]);
+  EXPECT_EQ(Collect(set, 8, 9), (std::vector<Interval>{{8, 12}}));
+}
+
+TEST(IntervalTests, RandomQueriesMatchLinearScan) {
+  std::mt19937 random(5);
+  s21::S21IntervalSet<int> set;
+  std::vector<Interval> all;
+  for (int i = 0; i < 3000; i++) {
+    int start = static_cast<int>(random() % 10000);
+    int length = static_cast<int>(random() % (i % 10 ? 50 : 2000));
+    if (set.insert(start, start + length).second) {
+      all.push_back({start, start + length});
+    }
+    if (i % 7 == 0 && !all.empty()) {
+      size_t victim = random() % all.size();
+      set.erase(all[victim]);
+      all.erase(all.begin() + victim);
+    }
+  }
+  std::sort(all.begin(), all.end());
+  for (int query = 0; query < 500; query++) {
+    int low = static_cast<int>(random() % 10500) - 250;
+    int high = low + 1 + static_cast<int>(random() % 300);
+    std::vector<Interval> expected;
+    std::vector<Interval> stabbed;
+    for (const Interval &interval : all) {
+      if (interval.first < high && low < interval.second) {
+        expected.push_back(interval);
+      }
+      if (interval.first <= low && low < interval.second) {
+        stabbed.push_back(interval);
+      }
+    }
+    ASSERT_EQ(Collect(set, low, high), expected);
+    std::vector<Interval> found;
+    for (auto it : set.overlapping(low)) {
+      ASSERT_EQ(*it, all[it - set.begin()]);
+      found.push_back(*it);
+    }
+    ASSERT_EQ(found, stabbed);
+  }
+}
+
+TEST(IntervalTests, BulkBuildFromSorted) {
+  std::vector<Interval> sorted;
+  for (int i = 0; i < 100000; i++) {
+    sorted.push_back({i * 10, i * 10 + 25});
+  }
+  s21::S21IntervalSet<int> set;
+  set.load_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(set.size(), sorted.size());
+  EXPECT_EQ(Collect(set, 500, 501),
+            (std::vector<Interval>{{480, 505}, {490, 515}, {500, 525}}));
+  std::vector<Interval> reversed = {{3, 1}};
+  EXPECT_THROW(set.load_sorted(reversed.begin(), reversed.end()),
+               std::invalid_argument);
+  std::vector<Interval> unsorted = {{5, 6}, {1, 2}};
+  EXPECT_THROW(set.load_sorted(unsorted.begin(), unsorted.end()),
+               std::invalid_argument);
+  EXPECT_EQ(set.size(), sorted.size());
+}
+
+TEST(IntervalTests, MapCarriesValues) {
+  s21::S21IntervalMap<unsigned, std::string> blocks = {
+      {{0x0A000000, 0x0B000000}, "private"},
+      {{0x7F000000, 0x80000000}, "loopback"}};
+  EXPECT_TRUE(blocks.insert(0x0A010000, 0x0A020000, "lab").second);
+  EXPECT_FALSE(blocks.insert(0x0A010000, 0x0A020000, "other").second);
+  std::vector<std::string> names;
+  blocks.for_each_overlapping(0x0A010203, [&names](const auto &entry) {
+    names.push_back(entry.second);
+  });
+  EXPECT_EQ(names, (std::vector<std::string>{"private", "lab"}));
+  blocks.insert_or_assign(0x0A010000, 0x0A020000, "staging");
+  EXPECT_EQ(blocks.at(0x0A010000, 0x0A020000), "staging");
+  EXPECT_TRUE(blocks.contains(0x7F000000, 0x80000000));
+  EXPECT_FALSE(blocks.contains(0x7F000000, 0x7F000001));
+  EXPECT_THROW(blocks.at(1, 2), std::out_of_range);
+  EXPECT_TRUE(blocks.overlapping(0x0C000000).empty());
+  EXPECT_EQ(blocks.overlapping(0x0A7F0000, 0x7F000001).size(), 2U);
+}
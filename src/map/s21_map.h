@@ -1,33 +1,68 @@
 #ifndef CPP2_S21_CONTAINERS_2_MAP_S21_MAP_H_
 #define CPP2_S21_CONTAINERS_2_MAP_S21_MAP_H_
 
+#include <tuple>
+#include <utility>
+
 #include "../binary_search_tree/binary_search_tree.h"
-#include "../list/s21_list.h"
 
 namespace s21 {
 
-template <typename Key, typename T>
-class S21Map : public s21::BinarySearchTree<std::pair<Key, T>> {
+// Orders map entries by key only, so the mapped value is never touched
+// (or copied) during a descent.
+template <typename Key, typename T, typename Compare>
+struct MapKeyCompare {
+  Compare key_compare = Compare();
+  auto operator()(const std::pair<Key, T> &a,
+                  const std::pair<Key, T> &b) const {
+    return key_compare(a.first, b.first);
+  }
+};
+
+// Augment keeps a summary of every subtree (see augment.h), making
+// aggregate over a key range O(log n). When the summaries read mapped
+// values (summarizes_mapped), at, operator[] and iterators give read-only
+// access to them and values change through insert_or_assign or update,
+// which refresh the summaries above the entry.
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Augment = NoAugment>
+class S21Map
+    : public s21::BinarySearchTree<std::pair<Key, T>,
+                                   MapKeyCompare<Key, T, Compare>, Augment> {
   using key_type = Key;
   using mapped_type = T;
+  using key_compare = Compare;
   using value_type = std::pair<key_type, mapped_type>;
   using reference = std::pair<const key_type, mapped_type> &;
   using const_reference = const reference;
-  using BinaryTree = BinarySearchTree<value_type>;
-  using iterator = typename BinaryTree::Iterator;
+  using BinaryTree =
+      BinarySearchTree<value_type, MapKeyCompare<Key, T, Compare>, Augment>;
+  static constexpr bool read_only_values_ = summarizes_mapped<Augment>::value;
+  using mapped_reference =
+      std::conditional_t<read_only_values_, const T &, T &>;
   using const_iterator = typename BinaryTree::ConstIterator;
+  using iterator = std::conditional_t<read_only_values_, const_iterator,
+                                      typename BinaryTree::Iterator>;
   using size_type = size_t;
-  using node = typename BinarySearchTree<value_type>::node;
+  using node = typename BinaryTree::node;
 
  public:
+  using arena_type = typename BinaryTree::arena_type;
+  using node_type = typename BinaryTree::node_type;
+  using summary_type = typename BinaryTree::summary_type;
+
   S21Map() noexcept
-      : BinaryTree::BinarySearchTree(compare_) {
+      : BinaryTree::BinarySearchTree() {
   }  // default constructor, creates an empty map
+  explicit S21Map(const Compare &comp) noexcept
+      : BinaryTree::BinarySearchTree(
+            MapKeyCompare<Key, T, Compare>{comp}) {
+  }  // creates an empty map ordered by comp
+  explicit S21Map(std::shared_ptr<arena_type> arena) noexcept
+      : BinaryTree::BinarySearchTree(std::move(arena)) {
+  }  // creates an empty map allocating nodes from a shared arena
   S21Map(std::initializer_list<value_type> const &items) {
-    BinaryTree::custom_compare_ = compare_;
-    for (auto it = items.begin(); it != items.end(); it++) {
-      insert(*it);
-    }
+    this->load(items.begin(), items.end());
   };  // initializer list constructor, creates the map
       // initizialized using std::initializer_list
   S21Map(const S21Map &m)
@@ -35,18 +70,45 @@ class S21Map : public s21::BinarySearchTree<std::pair<Key, T>> {
   S21Map(S21Map &&m) noexcept
       : BinaryTree::BinarySearchTree(std::move(m)) {}  // move constructor
 
-  S21Map<Key, T> &operator=(
+  S21Map<Key, T, Compare, Augment> &operator=(
       const S21Map &m);  // assignment operator overload for copying an object
   S21Map &operator=(S21Map &&m) noexcept;  // assignment operator overload for
                                            // moving an object
-  T &at(const Key &key);  // access a specified element with bounds checking
-  T &operator[](const Key &key);  // access or insert specified element
+  mapped_reference at(
+      const Key &key);  // access a specified element with bounds checking
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  mapped_reference at(
+      const K &key);  // same for any K that Compare orders against Key
+  mapped_reference operator[](
+      const Key &key);  // access or insert specified element
+  mapped_reference operator[](
+      Key &&key);  // same, moving key into a new entry
+  template <typename Fn>
+  void update(const Key &key,
+              Fn fn);  // calls fn on the value mapped to key and refreshes
+                       // the summaries that depend on it; throws
+                       // std::out_of_range if key is absent
+  iterator begin() const noexcept {
+    return BinaryTree::begin();
+  }  // the entry with the smallest key
+  iterator end() const noexcept {
+    return BinaryTree::end();
+  }  // the position after the last entry
+  iterator nth(size_type index) const noexcept {
+    return BinaryTree::nth(index);
+  }  // the entry with in-order index index, or end()
+  std::pair<iterator, iterator> equal_range(const Key &key) const noexcept {
+    return std::make_pair(lower_bound(key), upper_bound(key));
+  }  // the entries with key, as a range of at most one
 
   std::pair<iterator, bool> insert(
       const value_type
           &value);  // inserts a node and returns an iterator to where the
                     // element is in the container and bool denoting whether
                     // the insertion took place
+  std::pair<iterator, bool> insert(
+      value_type &&value);  // same, moving value into the new node
   std::pair<iterator, bool> insert(
       const Key &key,
       const T &obj);  // inserts a value by key and returns an iterator to
@@ -56,147 +118,450 @@ class S21Map : public s21::BinarySearchTree<std::pair<Key, T>> {
       const Key &key,
       const T &obj);         // inserts an element or assigns to the
                              // current element if the key already exists
+  std::pair<iterator, bool> insert_or_assign(
+      const Key &key, T &&obj);  // same, moving obj into place
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(
+      Args &&...args);  // constructs an entry from args in its node, keeping
+                        // it only if the key is not present yet
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(
+      const Key &key,
+      Args &&...args);  // constructs the value from args only if the key is
+                        // not present yet
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(
+      Key &&key, Args &&...args);  // same, moving key into the new entry
   void erase(iterator pos);  // erases an element at pos
+  iterator erase(const_iterator first, const_iterator last) {
+    return BinaryTree::erase(first, last);
+  }  // erases [first, last) in O(log n + k), returns the element after it
+  size_type erase_range(
+      const Key &low,
+      const Key &high);  // erases the keys in [low, high), returns how many
+  template <typename Fn>
+  void for_each_in_range(const Key &low, const Key &high, Fn fn)
+      const;  // calls fn on every entry with a key in [low, high), in order
   void swap(S21Map &other) noexcept;  // swaps the contents
   void merge(S21Map &other);          // splices nodes from another container
+  void unite(S21Map &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::unite, threads);
+  }  // adds the keys of other, keeping this map's values for shared keys
+  void intersect(S21Map &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::intersect, threads);
+  }  // keeps only the keys also present in other
+  void subtract(S21Map &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::subtract, threads);
+  }  // drops the keys present in other
+  std::pair<iterator, bool> insert(node_type &&handle) {
+    return BinaryTree::insert(std::move(handle));
+  }  // links an extracted node unless its key is already present
+  iterator insert(const_iterator hint, const value_type &value) {
+    return BinaryTree::insert(hint, value);
+  }  // inserts value, in O(1) comparisons when it belongs right before hint
+  iterator insert(const_iterator hint, value_type &&value) {
+    return BinaryTree::insert(hint, std::move(value));
+  }  // moves value in, using hint as the position
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return BinaryTree::emplace_hint(hint, std::forward<Args>(args)...);
+  }  // constructs an element in place, using hint as the position
+  node_type extract(iterator pos) noexcept {
+    return BinaryTree::extract(tree_iterator_(pos));
+  }  // unlinks the element at pos and hands its node over
+  node_type extract(
+      const Key &key) noexcept;  // unlinks the element with key, if any
   bool contains(
       const Key &key) const noexcept;  // checks if there is an element with key
                                        // equivalent to key in the container
+  // With a transparent Compare (one defining is_transparent, such as
+  // std::less<>) the lookups below also accept any K it can order against
+  // Key, e.g. a std::string_view for std::string keys, without building a
+  // Key from it.
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K &key) const noexcept;
+  iterator find(const Key &key)
+      const noexcept;  // the entry with key, or end() if there is none
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K &key) const noexcept;
+  size_type count(const Key &key)
+      const noexcept;  // 1 if an entry has key, 0 otherwise
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K &key) const noexcept;
+  iterator lower_bound(const Key &key)
+      const noexcept;  // the first entry whose key is not less than key
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K &key) const noexcept;
+  iterator upper_bound(const Key &key)
+      const noexcept;  // the first entry whose key is greater than key
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K &key) const noexcept;
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt find_many(ForwardIt first, ForwardIt last, OutputIt out) const {
+    return this->find_many_(first, last, out, key_less_());
+  }  // writes find(key) for every key in [first, last), descending for
+     // several keys at once to overlap their cache misses
+  template <typename ForwardIt, typename OutputIt>
+  OutputIt contains_many(ForwardIt first, ForwardIt last,
+                         OutputIt out) const {
+    return this->contains_many_(first, last, out, key_less_());
+  }  // writes contains(key) for every key in [first, last), batched the
+     // same way
+  size_type rank(const Key &key)
+      const noexcept;  // returns the number of keys ordered before key
+  size_type count_range(const Key &low, const Key &high)
+      const noexcept;  // returns the number of keys in [low, high)
+  summary_type aggregate(const Key &low, const Key &high)
+      const;  // combines the summaries of the entries with keys in
+              // [low, high), in O(log n)
   // S21Vector<std::pair<iterator, bool>> insert_many(Args&&... args);
+  key_compare key_comp() const {
+    return BinaryTree::comp_.key_compare;
+  }  // returns the function that compares keys
 
  private:
-  static int compare_(value_type a, value_type b);
-
+  using slot_ = typename BinaryTree::slot_;
+  typename BinaryTree::Iterator tree_iterator_(
+      const const_iterator &pos) const noexcept {
+    return typename BinaryTree::Iterator(this, this->node_of_(pos));
+  }
   node *find_node_by_key_(const Key &key) const noexcept;
+  template <typename K>
+  slot_ find_key_slot_(const K &key) const noexcept;
+  template <typename K>
+  T &at_(const K &key);
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_(K &&key, Args &&...args);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign_(const Key &key, M &&obj);
+  template <typename K>
+  static const K &key_of_(const K &key) noexcept {
+    return key;
+  }
+  static const Key &key_of_(const value_type &entry) noexcept {
+    return entry.first;
+  }
+  // Orders entries and probe keys, in either position, by key alone.
+  auto key_less_() const noexcept {
+    return [this](const auto &a, const auto &b) {
+      return compare_less(this->comp_.key_compare, key_of_(a), key_of_(b));
+    };
+  }
+  // Holds for the entries ordered after a probe key or equal to it.
+  auto key_not_greater_() const noexcept {
+    return [less = key_less_()](const auto &entry, const auto &key) {
+      return !less(key, entry);
+    };
+  }
 };
 
-template <typename Key, typename T>
-std::pair<typename S21Map<Key, T>::iterator, bool> S21Map<Key, T>::insert(
-    const value_type &value) {
-  if (!contains(value.first)) {
-    return BinaryTree::insert(value);
-  } else {
-    return BinaryTree::insert(value, 0);
+// Every insertion below descends once, comparing keys only: the slot it
+// finds is either the existing entry or the place of the new one, and the
+// entry is only constructed in the latter case.
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K>
+typename S21Map<Key, T, Compare, Augment>::slot_
+S21Map<Key, T, Compare, Augment>::find_key_slot_(
+    const K &key) const noexcept {
+  return this->find_slot_(key, key_less_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert(const value_type &value) {
+  return this->insert_unique_(value);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert(value_type &&value) {
+  return this->insert_unique_(std::move(value));
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert(const Key &key, const T &obj) {
+  return try_emplace(key, obj);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert_or_assign(const Key &key,
+                                                   const T &obj) {
+  return insert_or_assign_(key, obj);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert_or_assign(const Key &key, T &&obj) {
+  return insert_or_assign_(key, std::move(obj));
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename M>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::insert_or_assign_(const Key &key,
+                                                    M &&obj) {
+  slot_ slot = find_key_slot_(key);
+  if (slot.found()) {
+    slot.parent->info.second = std::forward<M>(obj);
+    this->refresh_path_(slot.parent);
+    return std::make_pair(this->iterator_at_(slot), false);
   }
+  node *entry = this->emplace_node_(key, std::forward<M>(obj));
+  return std::make_pair(this->link_at_(slot, entry), true);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename... Args>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::emplace(Args &&...args) {
+  return BinaryTree::emplace(std::forward<Args>(args)...);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename... Args>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::try_emplace(const Key &key, Args &&...args) {
+  return try_emplace_(key, std::forward<Args>(args)...);
 }
 
-template <typename Key, typename T>
-std::pair<typename S21Map<Key, T>::iterator, bool> S21Map<Key, T>::insert(
-    const Key &key, const T &obj) {
-  if (!contains(key)) {
-    return BinaryTree::insert(std::make_pair(key, obj));
-  } else {
-    value_type val = std::make_pair(key, obj);
-    iterator it(this->root_, this->find_node_by_value_(val),
-                this->find_index_by_value_(val));
-    return std::make_pair(it, false);
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename... Args>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::try_emplace(Key &&key, Args &&...args) {
+  return try_emplace_(std::move(key), std::forward<Args>(args)...);
+}
+
+// The key is only moved from once the descent has shown it is absent, so
+// a failed try_emplace leaves both key and args untouched.
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename... Args>
+std::pair<typename S21Map<Key, T, Compare, Augment>::iterator, bool>
+S21Map<Key, T, Compare, Augment>::try_emplace_(K &&key, Args &&...args) {
+  slot_ slot = find_key_slot_(key);
+  if (slot.found()) {
+    return std::make_pair(this->iterator_at_(slot), false);
   }
+  node *entry = this->emplace_node_(
+      std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+      std::forward_as_tuple(std::forward<Args>(args)...));
+  return std::make_pair(this->link_at_(slot, entry), true);
 }
 
-template <typename Key, typename T>
-std::pair<typename S21Map<Key, T>::iterator, bool>
-S21Map<Key, T>::insert_or_assign(const Key &key, const T &obj) {
-  if (contains(key)) {
-    node *n = find_node_by_key_(key);
-    iterator it(this->root_, n, this->find_index_by_value_(n->info));
-    it->second = obj;
-    return std::make_pair(it, false);
+template <typename Key, typename T, typename Compare, typename Augment>
+void S21Map<Key, T, Compare, Augment>::erase(iterator pos) {
+  BinaryTree::erase(tree_iterator_(pos));
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::size_type
+S21Map<Key, T, Compare, Augment>::erase_range(const Key &low, const Key &high) {
+  size_type from = rank(low);
+  size_type to = rank(high);
+  if (from >= to) {
+    return 0;
   }
-  return insert(key, obj);
+  this->erase_positions_(from, to);
+  return to - from;
 }
 
-template <typename Key, typename T>
-void S21Map<Key, T>::erase(iterator pos) {
-  BinaryTree::erase(pos);
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename Fn>
+void S21Map<Key, T, Compare, Augment>::for_each_in_range(const Key &low,
+                                                         const Key &high,
+                                                         Fn fn) const {
+  this->for_each_at_(rank(low), rank(high), fn);
 }
 
-template <typename Key, typename T>
-void S21Map<Key, T>::swap(S21Map &other) noexcept {
-  node *tmp = BinaryTree::root_;
-  BinaryTree::root_ = other.root_;
-  other.root_ = tmp;
+template <typename Key, typename T, typename Compare, typename Augment>
+void S21Map<Key, T, Compare, Augment>::swap(S21Map &other) noexcept {
+  BinaryTree::swap(other);
 }
 
-template <typename Key, typename T>
-void S21Map<Key, T>::merge(S21Map &other) {
-  S21List<value_type> to_erase;
-  for (auto it = other.begin(); it != other.end(); it++) {
-    if (insert(*it).second) {
-      to_erase.push_front(*it);
-    }
-  }
-  for (auto it = to_erase.begin(); it != to_erase.end(); it++) {
-    other.BinaryTree::erase(*it);
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::size_type
+S21Map<Key, T, Compare, Augment>::rank(
+    const Key &key) const noexcept {
+  return this->count_before_(key,
+                             [this](const value_type &entry, const Key &k) {
+                               return compare_less(
+                                   this->comp_.key_compare, entry.first, k);
+                             });
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::size_type
+S21Map<Key, T, Compare, Augment>::count_range(const Key &low,
+                                              const Key &high) const noexcept {
+  size_type below_high = rank(high);
+  size_type below_low = rank(low);
+  return below_high > below_low ? below_high - below_low : 0;
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::summary_type
+S21Map<Key, T, Compare, Augment>::aggregate(const Key &low,
+                                            const Key &high) const {
+  return this->aggregate_at_(rank(low), rank(high));
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+void S21Map<Key, T, Compare, Augment>::merge(S21Map &other) {
+  BinaryTree::merge(other);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::node_type
+S21Map<Key, T, Compare, Augment>::extract(
+    const Key &key) noexcept {
+  node *found = find_node_by_key_(key);
+  if (found == nullptr) {
+    return node_type();
   }
+  return BinaryTree::extract(typename BinaryTree::Iterator(this, found));
 }
 
-template <typename Key, typename T>
-bool S21Map<Key, T>::contains(const Key &key) const noexcept {
+template <typename Key, typename T, typename Compare, typename Augment>
+bool S21Map<Key, T, Compare, Augment>::contains(const Key &key) const noexcept {
   if (find_node_by_key_(key)) {
     return true;
   }
   return false;
 }
 
-template <typename Key, typename T>
-typename S21Map<Key, T>::node *S21Map<Key, T>::find_node_by_key_(
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+bool S21Map<Key, T, Compare, Augment>::contains(const K &key) const noexcept {
+  return find_key_slot_(key).found();
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::find(const Key &key) const noexcept {
+  return this->find_(key, key_less_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::find(const K &key) const noexcept {
+  return this->find_(key, key_less_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::size_type
+S21Map<Key, T, Compare, Augment>::count(const Key &key) const noexcept {
+  return find_key_slot_(key).found() ? 1 : 0;
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename S21Map<Key, T, Compare, Augment>::size_type
+S21Map<Key, T, Compare, Augment>::count(const K &key) const noexcept {
+  return find_key_slot_(key).found() ? 1 : 0;
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::lower_bound(const Key &key) const noexcept {
+  return this->first_not_before_(key, key_less_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::lower_bound(const K &key) const noexcept {
+  return this->first_not_before_(key, key_less_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::upper_bound(const Key &key) const noexcept {
+  return this->first_not_before_(key, key_not_greater_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename S21Map<Key, T, Compare, Augment>::iterator
+S21Map<Key, T, Compare, Augment>::upper_bound(const K &key) const noexcept {
+  return this->first_not_before_(key, key_not_greater_());
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::node *
+S21Map<Key, T, Compare, Augment>::find_node_by_key_(
     const Key &key) const noexcept {
-  node *cur = BinaryTree::root_;
-  while (cur && cur->info.first != key) {
-    if (cur->info.first > key) {
-      cur = cur->left;
-    } else {
-      cur = cur->right;
-    }
-  }
-  return cur;
-}
-
-template <typename Key, typename T>
-T &S21Map<Key, T>::operator[](const Key &key) {
-  if (!contains(key)) {
-    mapped_type *a = new mapped_type;
-    auto &res = insert_or_assign(key, *a).first->second;
-    delete a;
-    return res;
-  } else {
-    return at(key);
-  }
+  slot_ slot = find_key_slot_(key);
+  return slot.found() ? slot.parent : nullptr;
+}
+
+// A missing key gets a value-initialized mapped value, built in its node.
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::mapped_reference
+S21Map<Key, T, Compare, Augment>::operator[](const Key &key) {
+  return try_emplace(key).first->second;
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::mapped_reference
+S21Map<Key, T, Compare, Augment>::operator[](Key &&key) {
+  return try_emplace(std::move(key)).first->second;
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+typename S21Map<Key, T, Compare, Augment>::mapped_reference
+S21Map<Key, T, Compare, Augment>::at(const Key &key) {
+  return at_(key);
 }
 
-template <typename Key, typename T>
-T &S21Map<Key, T>::at(const Key &key) {
-  node *a = find_node_by_key_(key);
-  if (a == nullptr) {
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K, typename C, typename>
+typename S21Map<Key, T, Compare, Augment>::mapped_reference
+S21Map<Key, T, Compare, Augment>::at(const K &key) {
+  return at_(key);
+}
+
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename K>
+T &S21Map<Key, T, Compare, Augment>::at_(const K &key) {
+  slot_ slot = find_key_slot_(key);
+  if (!slot.found()) {
     throw std::out_of_range("no such key in tree");
   }
-  return a->info.second;
+  return slot.parent->info.second;
 }
 
-template <typename Key, typename T>
-S21Map<Key, T> &S21Map<Key, T>::operator=(const S21Map &m) {
-  BinaryTree::operator=(m);
-  return *this;
+template <typename Key, typename T, typename Compare, typename Augment>
+template <typename Fn>
+void S21Map<Key, T, Compare, Augment>::update(const Key &key, Fn fn) {
+  node *entry = find_node_by_key_(key);
+  if (entry == nullptr) {
+    throw std::out_of_range("no such key in tree");
+  }
+  fn(entry->info.second);
+  this->refresh_path_(entry);
 }
 
-template <typename Key, typename T>
-S21Map<Key, T> &S21Map<Key, T>::operator=(S21Map &&m) noexcept {
+template <typename Key, typename T, typename Compare, typename Augment>
+S21Map<Key, T, Compare, Augment> &S21Map<Key, T, Compare, Augment>::operator=(
+    const S21Map &m) {
   BinaryTree::operator=(m);
   return *this;
 }
 
-template <typename Key, typename T>
-int S21Map<Key, T>::compare_(typename S21Map<Key, T>::value_type a,
-                             typename S21Map<Key, T>::value_type b) {
-  if (a.first > b.first) {
-    return 1;
-  }
-  if (a.first < b.first) {
-    return -1;
-  }
-  return 0;
+template <typename Key, typename T, typename Compare, typename Augment>
+S21Map<Key, T, Compare, Augment> &S21Map<Key, T, Compare, Augment>::operator=(
+    S21Map &&m) noexcept {
+  BinaryTree::operator=(std::move(m));
+  return *this;
 }
 
 }  // namespace s21
 
-#endif
\ No newline at end of file
+#endif
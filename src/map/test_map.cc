@@ -1,5 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
 #include "../s21_containers.h"
 
 TEST(MapTests, DefaultConstructor) {
@@ -388,4 +394,453 @@ TEST(MapTests, clear) {
   m2.clear();
   EXPECT_EQ(m1.size(), m2.size());
   EXPECT_EQ(m1.empty(), m2.empty());
-}
\ No newline at end of file
+}
+TEST(MapTests, SortedKeysStayBalanced) {
+  class HeightProbe : public s21::S21Map<int, int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  HeightProbe m;
+  for (int i = 2048; i > 0; i--) {
+    m.insert(i, -i);
+  }
+  EXPECT_EQ(m.size(), 2048U);
+  EXPECT_LE(m.height(), 16);
+  EXPECT_EQ(m.at(1), -1);
+  EXPECT_EQ(m.at(2048), -2048);
+  EXPECT_EQ((*m.begin()).first, 1);
+}
+
+TEST(MapTests, CustomKeyCompare) {
+  s21::S21Map<std::string, int, std::greater<std::string>> m{
+      {"b", 2}, {"a", 1}, {"c", 3}};
+  std::map<std::string, int, std::greater<std::string>> std_m{
+      {"b", 2}, {"a", 1}, {"c", 3}};
+  auto it = m.begin();
+  for (const auto &pair : std_m) {
+    EXPECT_EQ((*it).first, pair.first);
+    EXPECT_EQ((*it).second, pair.second);
+    ++it;
+  }
+  EXPECT_EQ(m.at("a"), 1);
+  EXPECT_TRUE(m.key_comp()("b", "a"));
+  m.clear();
+  m.insert("x", 1);
+  m.insert("x", 2);
+  EXPECT_EQ(m.size(), 1U);
+  EXPECT_EQ(m["x"], 1);
+}
+
+TEST(MapTests, SharedArena) {
+  using map_type = s21::S21Map<int, std::string>;
+  auto arena = std::make_shared<map_type::arena_type>();
+  {
+    map_type first(arena);
+    map_type second(arena);
+    for (int i = 0; i < 100; i++) {
+      first.insert(i, std::to_string(i));
+      second.insert(-i, std::to_string(i));
+    }
+    EXPECT_EQ(arena->live(), 200U);
+    EXPECT_EQ(first.at(42), "42");
+    EXPECT_EQ(second.at(-42), "42");
+  }
+  EXPECT_EQ(arena->live(), 0U);
+}
+
+TEST(MapTests, LoadKeepsFirstDuplicate) {
+  s21::S21Map<int, std::string> m{{3, "c"}, {1, "a"}, {3, "x"}, {2, "b"}};
+  std::map<int, std::string> std_m{{3, "c"}, {1, "a"}, {3, "x"}, {2, "b"}};
+  ASSERT_EQ(m.size(), std_m.size());
+  auto it = m.begin();
+  for (const auto &pair : std_m) {
+    EXPECT_EQ((*it).first, pair.first);
+    EXPECT_EQ((*it).second, pair.second);
+    ++it;
+  }
+  std::vector<std::pair<int, std::string>> sorted{{1, "a"}, {2, "b"}};
+  m.load_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(m.size(), 2U);
+  EXPECT_EQ(m.at(2), "b");
+  EXPECT_FALSE(m.contains(3));
+}
+
+TEST(MapTests, ExtractByKey) {
+  s21::S21Map<int, std::string> m1{{1, "one"}, {2, "two"}};
+  s21::S21Map<int, std::string> m2;
+  auto handle = m1.extract(2);
+  EXPECT_EQ(handle.value().second, "two");
+  EXPECT_TRUE(m2.insert(std::move(handle)).second);
+  EXPECT_EQ(m2.at(2), "two");
+  EXPECT_FALSE(m1.contains(2));
+  EXPECT_TRUE(m1.extract(5).empty());
+}
+
+TEST(MapTests, UniteKeepsOwnValues) {
+  s21::S21Map<int, std::string> m1{{1, "one"}, {2, "two"}, {4, "four"}};
+  s21::S21Map<int, std::string> m2{{2, "deux"}, {3, "trois"}};
+  m1.unite(std::move(m2));
+  EXPECT_EQ(m1.size(), 4U);
+  EXPECT_EQ(m1.at(2), "two");
+  EXPECT_EQ(m1.at(3), "trois");
+  EXPECT_TRUE(m2.empty());
+  m1.intersect(s21::S21Map<int, std::string>{{3, ""}, {4, ""}, {5, ""}});
+  EXPECT_EQ(m1.size(), 2U);
+  EXPECT_EQ(m1.at(4), "four");
+  m1.subtract(s21::S21Map<int, std::string>{{4, ""}});
+  EXPECT_EQ(m1.size(), 1U);
+  EXPECT_TRUE(m1.contains(3));
+}
+
+TEST(MapTests, RankByKey) {
+  s21::S21Map<int, std::string> m{{10, "a"}, {20, "b"}, {30, "c"}, {40, "d"}};
+  EXPECT_EQ(m.rank(30), 2U);
+  EXPECT_EQ(m.rank(35), 3U);
+  EXPECT_EQ(m.count_range(15, 40), 2U);
+  EXPECT_EQ(m.nth(1)->second, "b");
+  EXPECT_EQ((m.nth(3) - 2)->first, 20);
+}
+
+TEST(MapTests, EmplaceHint) {
+  s21::S21Map<int, std::string> m;
+  for (int i = 0; i < 100; i++) {
+    m.emplace_hint(m.end(), i, std::to_string(i));
+  }
+  auto it = m.insert(m.nth(50), {50, "fifty"});
+  EXPECT_EQ(it->second, "50");
+  EXPECT_EQ(m.size(), 100U);
+  EXPECT_EQ(m.at(99), "99");
+}
+
+struct CountingLess {
+  static int calls;
+  bool operator()(int a, int b) const {
+    calls++;
+    return a < b;
+  }
+};
+int CountingLess::calls = 0;
+
+// Every insertion path must find its slot and build its iterator in the
+// same single descent a lookup makes.
+TEST(MapTests, InsertionsDescendOnce) {
+  s21::S21Map<int, int, CountingLess> m;
+  for (int i = 0; i < 1000; i += 2) {
+    m.insert(i, i);
+  }
+  for (int key = -1; key < 1001; key += 37) {
+    CountingLess::calls = 0;
+    m.contains(key);
+    int lookup = CountingLess::calls;
+    CountingLess::calls = 0;
+    auto result = key % 3 ? m.try_emplace(key, 7) : m.insert(key, 7);
+    EXPECT_EQ(CountingLess::calls, lookup);
+    EXPECT_EQ(result.first->first, key);
+    EXPECT_EQ(static_cast<size_t>(result.first - m.begin()), m.rank(key));
+    CountingLess::calls = 0;
+    m.contains(key);
+    lookup = CountingLess::calls;
+    CountingLess::calls = 0;
+    EXPECT_FALSE(m.insert_or_assign(key, 8).second);
+    m[key]++;
+    EXPECT_EQ(CountingLess::calls, 2 * lookup);
+    EXPECT_EQ(m.at(key), 9);
+  }
+}
+
+struct Tracked {
+  static int constructed;
+  int value;
+  Tracked() : value(0) { constructed++; }
+  Tracked(int v, int scale) : value(v * scale) { constructed++; }
+  Tracked(const Tracked &other) : value(other.value) { constructed++; }
+};
+int Tracked::constructed = 0;
+
+TEST(MapTests, TryEmplaceBuildsValueOnce) {
+  s21::S21Map<std::string, Tracked> m;
+  Tracked::constructed = 0;
+  EXPECT_TRUE(m.try_emplace("a", 3, 5).second);
+  EXPECT_EQ(Tracked::constructed, 1);
+  EXPECT_FALSE(m.try_emplace("a", 4, 5).second);
+  EXPECT_EQ(Tracked::constructed, 1);
+  EXPECT_EQ(m.at("a").value, 15);
+  EXPECT_EQ(m["b"].value, 0);
+  EXPECT_EQ(m["a"].value, 15);
+  EXPECT_EQ(Tracked::constructed, 2);
+  EXPECT_EQ(m.size(), 2U);
+}
+
+// Entries keyed by expiry second: each tick drops everything that is due.
+TEST(MapTests, ExpireByKeyRange) {
+  s21::S21Map<int, std::string> buckets;
+  for (int second = 0; second < 100; second++) {
+    buckets.insert(second, "bucket " + std::to_string(second));
+  }
+  std::vector<std::string> expired;
+  buckets.for_each_in_range(10, 13, [&expired](const auto &entry) {
+    expired.push_back(entry.second);
+  });
+  EXPECT_EQ(expired,
+            (std::vector<std::string>{"bucket 10", "bucket 11", "bucket 12"}));
+  EXPECT_EQ(buckets.erase_range(0, 13), 13U);
+  EXPECT_EQ(buckets.begin()->first, 13);
+  EXPECT_EQ(buckets.erase_range(50, 1000), 50U);
+  EXPECT_EQ((*--buckets.end()).first, 49);
+  auto it = buckets.erase(buckets.nth(1), buckets.nth(3));
+  EXPECT_EQ(it->first, 16);
+  EXPECT_EQ(buckets.size(), 35U);
+  EXPECT_FALSE(buckets.contains(14));
+  EXPECT_EQ(buckets.at(16), "bucket 16");
+}
+
+// Rolling sums and maxima over key ranges, checked against a brute-force
+// scan after every kind of update.
+TEST(MapTests, AggregatesOverKeyRanges) {
+  using SumMap =
+      s21::S21Map<int, long, std::less<int>,
+                  s21::SumAugment<long, s21::ProjectMapped>>;
+  SumMap sums;
+  s21::S21Map<int, int, std::less<int>, s21::MaxAugment<int, s21::ProjectKey>>
+      keys;
+  unsigned seed = 1;
+  for (int step = 0; step < 3000; step++) {
+    seed = seed * 1103515245 + 12345;
+    int key = static_cast<int>(seed >> 8) % 500;
+    switch (step % 5) {
+      case 0:
+        sums.erase_range(key, key + 3);
+        keys.erase_range(key, key + 3);
+        break;
+      case 1:
+        sums.insert_or_assign(key, key * 2);
+        break;
+      default:
+        sums.insert(key, key);
+        keys[key] = key;
+    }
+    if (step % 50 == 0) {
+      SumMap copy(sums);
+      sums = copy;
+    }
+    int low = static_cast<int>(seed >> 4) % 500;
+    int high = low + static_cast<int>(seed % 120);
+    long expected = 0;
+    sums.for_each_in_range(low, high, [&expected](const auto &entry) {
+      expected += entry.second;
+    });
+    ASSERT_EQ(sums.aggregate(low, high), expected);
+    int largest = std::numeric_limits<int>::lowest();
+    keys.for_each_in_range(low, high, [&largest](const auto &entry) {
+      largest = std::max(largest, entry.first);
+    });
+    ASSERT_EQ(keys.aggregate(low, high), largest);
+  }
+  EXPECT_EQ(sums.aggregate(10, 5), 0);
+}
+
+// A map whose summaries read the mapped values only lets them change
+// through calls that refresh the summaries.
+TEST(MapTests, UpdateRefreshesAggregates) {
+  using SumMap =
+      s21::S21Map<int, long, std::less<int>,
+                  s21::SumAugment<long, s21::ProjectMapped>>;
+  static_assert(std::is_same<decltype(std::declval<SumMap &>()[0]),
+                             const long &>::value,
+                "mapped values of a summed map are read-only");
+  static_assert(
+      std::is_same<decltype(*std::declval<SumMap &>().begin()),
+                   const std::pair<int, long> &>::value,
+      "iterators of a summed map are read-only");
+  static_assert(std::is_same<decltype(std::declval<s21::S21Map<int, long> &>()
+                                          .at(0)),
+                             long &>::value,
+                "plain maps keep mutable values");
+  SumMap m;
+  for (int i = 0; i < 10; i++) {
+    m.insert(i, 1);
+  }
+  EXPECT_EQ(m.aggregate(0, 10), 10);
+  m.update(3, [](long &value) { value += 100; });
+  m.update(4, [](long &value) { value = 50; });
+  EXPECT_EQ(m.at(3), 101);
+  EXPECT_EQ(m.aggregate(0, 10), 159);
+  EXPECT_EQ(m.aggregate(4, 5), 50);
+  EXPECT_THROW(m.update(42, [](long &value) { value = 0; }),
+               std::out_of_range);
+  m.erase(m.find(4));
+  EXPECT_EQ(m.aggregate(0, 10), 109);
+  s21::S21Map<int, int, std::less<int>, s21::MaxAugment<int, s21::ProjectKey>>
+      keys = {{1, 1}, {2, 2}};
+  keys[2] = 20;
+  (*keys.begin()).second = 10;
+  EXPECT_EQ(keys.at(1), 10);
+  EXPECT_EQ(keys.aggregate(0, 5), 2);
+}
+
+// Summaries that own memory must be destroyed along with their nodes.
+struct ConcatAugment {
+  using summary_type = std::string;
+  static summary_type identity() { return std::string(); }
+  template <typename Entry>
+  static summary_type summarize(const Entry &entry) {
+    return std::string(20, static_cast<char>('a' + entry.first % 26));
+  }
+  static summary_type combine(const summary_type &left,
+                              const summary_type &right) {
+    return left + right;
+  }
+};
+
+TEST(MapTests, ClearDestroysNonTrivialSummaries) {
+  s21::S21Map<int, int, std::less<int>, ConcatAugment> m;
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 100; i++) {
+      m.insert(i, i);
+    }
+    EXPECT_EQ(m.aggregate(0, 1), std::string(20, 'a'));
+    EXPECT_EQ(m.aggregate(0, 100).size(), 2000U);
+    m.clear();
+    EXPECT_TRUE(m.empty());
+  }
+  m.insert(3, 3);
+  EXPECT_EQ(m.aggregate(0, 10), std::string(20, 'd'));
+}
+
+TEST(MapTests, HoldsMoveOnlyValues) {
+  s21::S21Map<std::string, std::unique_ptr<int>> m;
+  EXPECT_TRUE(m.try_emplace("a", new int(1)).second);
+  EXPECT_TRUE(m.emplace("b", std::make_unique<int>(2)).second);
+  EXPECT_FALSE(m.emplace("b", std::make_unique<int>(20)).second);
+  EXPECT_TRUE(m.insert({"c", std::make_unique<int>(3)}).second);
+  m["d"] = std::make_unique<int>(4);
+  auto five = std::make_unique<int>(5);
+  EXPECT_FALSE(m.insert_or_assign("a", std::move(five)).second);
+  EXPECT_EQ(*m.at("a"), 5);
+  EXPECT_EQ(*m.at("b"), 2);
+  std::string key = "e";
+  EXPECT_TRUE(m.try_emplace(std::move(key), new int(6)).second);
+  EXPECT_EQ(m.size(), 5U);
+  m.erase(m.begin());
+  EXPECT_FALSE(m.contains("a"));
+  s21::S21Map<std::string, std::unique_ptr<int>> moved;
+  moved = std::move(m);
+  EXPECT_EQ(moved.size(), 4U);
+  EXPECT_EQ(*moved.at("e"), 6);
+  EXPECT_TRUE(m.empty());
+}
+
+struct MoveTracked {
+  static int copies;
+  int value = 0;
+  MoveTracked() = default;
+  explicit MoveTracked(int v) : value(v) {}
+  MoveTracked(const MoveTracked &other) : value(other.value) { copies++; }
+  MoveTracked(MoveTracked &&other) noexcept : value(other.value) {}
+  MoveTracked &operator=(const MoveTracked &other) {
+    value = other.value;
+    copies++;
+    return *this;
+  }
+  MoveTracked &operator=(MoveTracked &&other) noexcept {
+    value = other.value;
+    return *this;
+  }
+};
+int MoveTracked::copies = 0;
+
+TEST(MapTests, RvaluesAreNeverCopied) {
+  s21::S21Map<int, MoveTracked> m;
+  MoveTracked::copies = 0;
+  m.insert(std::make_pair(1, MoveTracked(1)));
+  m.emplace(2, MoveTracked(2));
+  m.insert_or_assign(2, MoveTracked(20));
+  m.insert_or_assign(3, MoveTracked(3));
+  m.insert(m.end(), std::make_pair(4, MoveTracked(4)));
+  EXPECT_EQ(MoveTracked::copies, 0);
+  EXPECT_EQ(m.at(2).value, 20);
+  EXPECT_EQ(m.size(), 4U);
+}
+
+struct CountedName {
+  static int built;
+  std::string text;
+  CountedName(const char *t) : text(t) { built++; }
+  CountedName(const CountedName &other) : text(other.text) { built++; }
+};
+int CountedName::built = 0;
+
+struct CountedNameLess {
+  using is_transparent = void;
+  bool operator()(const CountedName &a, const CountedName &b) const {
+    return a.text < b.text;
+  }
+  bool operator()(const CountedName &a, std::string_view b) const {
+    return a.text < b;
+  }
+  bool operator()(std::string_view a, const CountedName &b) const {
+    return a < b.text;
+  }
+};
+
+TEST(MapTests, TransparentLookupBuildsNoKey) {
+  s21::S21Map<CountedName, int, CountedNameLess> m;
+  m.insert("beta", 2);
+  m.insert("alpha", 1);
+  m.insert("gamma", 3);
+  CountedName::built = 0;
+  std::string_view beta = "beta";
+  EXPECT_EQ(m.find(beta)->second, 2);
+  EXPECT_EQ(m.find(std::string_view("delta")), m.end());
+  EXPECT_TRUE(m.contains(beta));
+  EXPECT_EQ(m.count(std::string_view("zeta")), 0U);
+  EXPECT_EQ(m.at(beta), 2);
+  EXPECT_THROW(m.at(std::string_view("delta")), std::out_of_range);
+  EXPECT_EQ(m.lower_bound(std::string_view("b"))->second, 2);
+  EXPECT_EQ(m.upper_bound(beta)->second, 3);
+  EXPECT_EQ(m.upper_bound(std::string_view("gamma")), m.end());
+  EXPECT_EQ(CountedName::built, 0);
+  EXPECT_EQ(m.lower_bound(CountedName("gamma")) - m.begin(), 2);
+  EXPECT_EQ(m.find(CountedName("alpha")) - m.begin(), 0);
+  EXPECT_EQ(m.count(CountedName("alpha")), 1U);
+}
+
+TEST(MapTests, FindManyMatchesFind) {
+  s21::S21Map<int, int> m;
+  for (int key = 0; key < 2000; key += 3) {
+    m.insert(key, key * 2);
+  }
+  std::vector<int> keys;
+  for (int key = -5; key < 2010; key += 2) {
+    keys.push_back(key);
+  }
+  std::vector<decltype(m.begin())> found;
+  m.find_many(keys.begin(), keys.end(), std::back_inserter(found));
+  std::vector<bool> present(keys.size());
+  m.contains_many(keys.begin(), keys.end(), present.begin());
+  ASSERT_EQ(found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(found[i], m.find(keys[i]));
+    EXPECT_EQ(present[i], m.contains(keys[i]));
+    if (present[i]) {
+      EXPECT_EQ((*found[i]).second, keys[i] * 2);
+      EXPECT_EQ(static_cast<size_t>(found[i] - m.begin()), m.rank(keys[i]));
+    }
+  }
+  s21::S21Map<int, int> empty;
+  empty.find_many(keys.begin(), keys.begin() + 3, found.begin());
+  EXPECT_EQ(found[0], empty.end());
+}
+
+TEST(MapTests, InsertSortedKeepsExistingValues) {
+  s21::S21Map<int, std::string> m = {{2, "two"}, {5, "five"}};
+  std::vector<std::pair<int, std::string>> batch = {
+      {1, "one"}, {2, "deux"}, {3, "three"}, {3, "trois"}, {6, "six"}};
+  std::vector<bool> inserted;
+  m.insert_sorted(batch.begin(), batch.end(), std::back_inserter(inserted));
+  EXPECT_EQ(inserted, (std::vector<bool>{true, false, true, false, true}));
+  EXPECT_EQ(m.size(), 5U);
+  EXPECT_EQ(m.at(2), "two");
+  EXPECT_EQ(m.at(3), "three");
+  EXPECT_EQ((*m.nth(4)).second, "six");
+}
@@ -5,34 +5,60 @@
 
 namespace s21 {
 
-template <typename T>
-class S21Multiset : public BinarySearchTree<T> {
+template <typename T, typename Compare = std::less<T>>
+class S21Multiset : public BinarySearchTree<T, Compare> {
  public:
   using value_type = T;
-  using BinaryTree = BinarySearchTree<T>;
+  using key_compare = Compare;
+  using BinaryTree = BinarySearchTree<T, Compare>;
   using iterator = typename BinaryTree::Iterator;
+  using const_iterator = typename BinaryTree::ConstIterator;
   using node = typename BinaryTree::node;
+  using arena_type = typename BinaryTree::arena_type;
+  using node_type = typename BinaryTree::node_type;
   using size_type = typename BinaryTree::size_type;
   using Key = value_type;
   S21Multiset()
       : BinaryTree::BinarySearchTree() {
   }  // default constructor, creates empty set
+  explicit S21Multiset(const Compare &comp)
+      : BinaryTree::BinarySearchTree(comp) {
+  }  // creates empty set ordered by comp
+  explicit S21Multiset(std::shared_ptr<arena_type> arena) noexcept
+      : BinaryTree::BinarySearchTree(std::move(arena)) {
+  }  // creates empty set allocating nodes from a shared arena
   S21Multiset(std::initializer_list<value_type> const
                   &items);  // initializer list constructor, creates the set
                             // initizialized using std::initializer_list
   S21Multiset(const S21Multiset &ms)
       : BinaryTree::BinarySearchTree(ms) {}  // copy constructor
-  S21Multiset(node *root) { this->root_ = root; }
   S21Multiset(S21Multiset &&ms) noexcept
       : BinaryTree::BinarySearchTree(std::move(ms)) {}  // move constructor
-  std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
-      value_type &val, int insertion = 1) override;  // insertion override
-  std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
-      value_type &&val) {
-    return insert(val);
-  }
-  std::pair<typename BinarySearchTree<T>::Iterator, bool> insert(
+  std::pair<iterator, bool> insert(const value_type &val,
+                                   int insertion = 1) {
+    return insert_new_node_(this->construct_node_(val), insertion);
+  }  // copies val in after the elements equal to it
+  std::pair<iterator, bool> insert(value_type &&val, int insertion = 1) {
+    return insert_new_node_(this->construct_node_(std::move(val)), insertion);
+  }  // moves val in after the elements equal to it
+  std::pair<iterator, bool> insert(
       node *val, int insertion = 1) override;  // insertion override
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return insert_new_node_(
+        this->emplace_node_(std::forward<Args>(args)...), 1);
+  }  // constructs an element in place after the elements equal to it
+  iterator insert(const_iterator hint, const value_type &value) {
+    return this->insert_hint_value_(hint, value, false);
+  }  // inserts value right before hint when it belongs there
+  iterator insert(const_iterator hint, value_type &&value) {
+    return this->insert_hint_value_(hint, std::move(value), false);
+  }  // moves value in right before hint when it belongs there
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return this->insert_hint_node_(
+        hint, this->emplace_node_(std::forward<Args>(args)...), false);
+  }  // constructs an element in place, using hint as the position
   S21Multiset &operator=(S21Multiset &another) {
     BinaryTree::operator=(another);
     return *this;
@@ -41,158 +67,104 @@ class S21Multiset : public BinarySearchTree<T> {
     BinaryTree::operator=(std::move(another));
     return *this;
   }  // assignment move operator
-  size_type count(const Key &key)
-      const noexcept;  // returns the number of elements matching specific key
-  std::pair<iterator, iterator> equal_range(const Key &key)
-      const noexcept;  // returns range of elements matching a specific key
-  iterator lower_bound(
-      const Key &key) const noexcept;  // returns an iterator to the first
-                                       // element not less than the given key
-  iterator upper_bound(
-      const Key &key) const noexcept;  // returns an iterator to the first
-                                       // element greater than the given key
-  void merge(
-      S21Multiset &another) noexcept;  // merges elements from another multiset
+  std::pair<iterator, bool> insert(
+      node_type &&handle);  // links an extracted node
+  void merge(S21Multiset &another);  // splices every node of another
+  template <typename ForwardIt>
+  void load_sorted(ForwardIt first, ForwardIt last) {
+    this->build_from_sorted_(first, last, false);
+  }  // replaces the contents with a sorted range in O(n), keeping duplicates
+  template <typename InputIt>
+  void load(InputIt first,
+            InputIt last);  // sorts a range and replaces the contents with it
+  template <typename ForwardIt>
+  size_type insert_sorted(ForwardIt first, ForwardIt last) {
+    this->insert_sorted_(first, last, false, [](bool) {});
+    return static_cast<size_type>(std::distance(first, last));
+  }  // inserts a sorted run, each element after the equal ones, searching
+     // from where the previous one landed
 
  private:
-  std::pair<node *, int> define_place_for_new_node_(value_type val,
-                                                    int insertion = 0) noexcept;
+  std::pair<node *, int> define_place_for_new_node_(
+      const value_type &val) noexcept;
   std::pair<iterator, bool> insert_new_node_(node *new_node,
                                              int insertion) noexcept;
 };
 
-template <typename T>
-void S21Multiset<T>::merge(S21Multiset &another) noexcept {
-  for (auto it = another.begin(); it != another.end(); it++) {
-    insert(*it);
+// Every node of another is relinked here, in order, without copying.
+template <typename T, typename Compare>
+void S21Multiset<T, Compare>::merge(S21Multiset &another) {
+  if (this == &another) {
+    return;
   }
-  another.clear();
-}
-
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool> S21Multiset<T>::insert(
-    value_type &val, int insertion) {
-  node *new_node = BinaryTree::construct_node_(val);
-  return insert_new_node_(new_node, insertion);
-}
-
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool> S21Multiset<T>::insert(
-    node *val, int insertion) {
-  return insert_new_node_(val, insertion);
-}
-
-template <typename T>
-S21Multiset<T>::S21Multiset(std::initializer_list<value_type> const &items) {
-  for (auto it = items.begin(); it != items.end(); it++) {
-    value_type to_insert = *it;
-    insert(to_insert, 1);
+  node *cur = another.leftmost_;
+  while (cur) {
+    node *next = BinaryTree::next_node_(cur);
+    another.unlink_node_(cur);
+    node *adopted = nullptr;
+    try {
+      adopted = this->adopt_node_(cur, another.arena_);
+    } catch (...) {
+      another.insert_new_node_(cur, 1);
+      throw;
+    }
+    insert_new_node_(adopted, 1);
+    cur = next;
   }
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::Iterator, bool>
-S21Multiset<T>::insert_new_node_(node *new_node, int insertion) noexcept {
-  if (this->root_ == nullptr) {
-    this->root_ = new_node;
-    iterator it(this->root_, 0);
-    return std::make_pair(it, true);
+template <typename T, typename Compare>
+std::pair<typename S21Multiset<T, Compare>::iterator, bool>
+S21Multiset<T, Compare>::insert(node_type &&handle) {
+  if (handle.empty()) {
+    return std::make_pair(this->end(), false);
   }
-  auto place = define_place_for_new_node_(new_node->info, insertion);
-  if (place.second == 1) {
-    place.first->right = new_node;
-    iterator it(this->root_, new_node,
-                this->find_index_by_value_(new_node->info));
-    return std::make_pair(it, true);
-  }
-  place.first->left = new_node;
-  iterator it(this->root_, new_node,
-              this->find_index_by_value_(new_node->info));
-  return std::make_pair(it, true);
+  return insert_new_node_(this->adopt_handle_(handle), 1);
 }
 
-template <typename T>
-std::pair<typename BinarySearchTree<T>::node *, int>
-S21Multiset<T>::define_place_for_new_node_(value_type val,
-                                           int insertion) noexcept {
-  insertion = 1;
-  node *current = this->root_;
-  node *prev = nullptr;
-  int side = 0;
-  while (current) {
-    if (val >= current->info) {
-      current->right_descendents_amount += insertion;
-      prev = current;
-      current = current->right;
-      side = right_side;
-    } else {
-      current->left_descendents_amount += insertion;
-      prev = current;
-      current = current->left;
-      side = left_side;
-    }
-  }
-  return std::make_pair(prev, side);
+template <typename T, typename Compare>
+std::pair<typename S21Multiset<T, Compare>::iterator, bool>
+S21Multiset<T, Compare>::insert(node *val, int insertion) {
+  return insert_new_node_(val, insertion);
 }
 
-template <typename T>
-typename S21Multiset<T>::size_type S21Multiset<T>::count(
-    const Key &key) const noexcept {
-  if (this->root_ == nullptr) {
-    return 0;
-  }
-  auto it = this->find(key);
-  size_type count = 0;
-  while (it != this->end() && *it == key) {
-    count++;
-    *it++;
-  }
-  return count;
+template <typename T, typename Compare>
+S21Multiset<T, Compare>::S21Multiset(
+    std::initializer_list<value_type> const &items) {
+  load(items.begin(), items.end());
 }
 
-template <typename T>
-std::pair<typename S21Multiset<T>::iterator, typename S21Multiset<T>::iterator>
-S21Multiset<T>::equal_range(const Key &key) const noexcept {
-  if (this->root_ == nullptr) {
-    iterator it(this->root_);
-    return std::make_pair(it, it);
-  }
-  auto start_of_range = this->find(key);
-  auto end_of_range = start_of_range;
-  while (*start_of_range == *end_of_range) {
-    end_of_range++;
-  }
-  return std::make_pair(start_of_range, end_of_range);
+template <typename T, typename Compare>
+template <typename InputIt>
+void S21Multiset<T, Compare>::load(InputIt first, InputIt last) {
+  std::vector<value_type> items(first, last);
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const value_type &a, const value_type &b) {
+                     return this->less_(a, b);
+                   });
+  this->build_from_sorted_(std::make_move_iterator(items.begin()),
+                           std::make_move_iterator(items.end()), false);
 }
 
-template <typename T>
-typename S21Multiset<T>::iterator S21Multiset<T>::lower_bound(
-    const Key &key) const noexcept {
-  if (this->root_ == nullptr) {
-    iterator it(this->root_);
-    return it;
-  }
-  node *cur = this->root_;
-  while (cur->info < key) {
-    cur = cur->right;
+template <typename T, typename Compare>
+std::pair<typename S21Multiset<T, Compare>::iterator, bool>
+S21Multiset<T, Compare>::insert_new_node_(node *new_node,
+                                          int insertion) noexcept {
+  if (insertion == 0) {
+    this->destroy_node_(new_node);
+    return std::make_pair(this->end(), false);
   }
-  iterator it(this->root_, cur, this->find_index_by_value_(cur->info));
-  return it;
+  auto place = define_place_for_new_node_(new_node->info);
+  this->link_node_(place.first, place.second, new_node);
+  iterator it(this, new_node);
+  return std::make_pair(it, true);
 }
 
-template <typename T>
-typename S21Multiset<T>::iterator S21Multiset<T>::upper_bound(
-    const Key &key) const noexcept {
-  if (this->root_ == nullptr) {
-    iterator it(this->root_);
-    return it;
-  }
-  node *cur = this->root_;
-  while (!(cur->info > key)) {
-    cur = cur->right;
-  }
-  iterator it(this->root_, cur, this->find_index_by_value_(cur->info));
-  return it;
+template <typename T, typename Compare>
+std::pair<typename BinarySearchTree<T, Compare>::node *, int>
+S21Multiset<T, Compare>::define_place_for_new_node_(
+    const value_type &val) noexcept {
+  return this->place_after_equals_(val);
 }
 }  // namespace s21
 
@@ -337,3 +337,154 @@ TEST(MultisetTest, allcase) {
   my_multiset.erase(it);
   EXPECT_EQ(my_multiset.size(), 8U);
 }
+
+TEST(MultisetTest, SortedDuplicatesStayBalanced) {
+  class HeightProbe : public s21::S21Multiset<int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  HeightProbe set;
+  std::multiset<int> std_set;
+  for (int i = 0; i < 1000; i++) {
+    set.insert(i / 4);
+    std_set.insert(i / 4);
+  }
+  EXPECT_EQ(set.size(), std_set.size());
+  EXPECT_LE(set.height(), 15);
+  EXPECT_EQ(set.count(7), std_set.count(7));
+  EXPECT_EQ(*set.lower_bound(100), *std_set.lower_bound(100));
+  EXPECT_EQ(*set.upper_bound(100), *std_set.upper_bound(100));
+  auto it = set.begin();
+  for (const auto &std_data : std_set) {
+    EXPECT_EQ(*it, std_data);
+    ++it;
+  }
+}
+
+TEST(MultisetTest, CustomCompare) {
+  s21::S21Multiset<int, std::greater<int>> set{1, 5, 1, 3, 5, 5};
+  std::multiset<int, std::greater<int>> std_set{1, 5, 1, 3, 5, 5};
+  EXPECT_EQ(set.count(5), std_set.count(5));
+  EXPECT_EQ(*set.lower_bound(4), *std_set.lower_bound(4));
+  EXPECT_EQ(*set.upper_bound(5), *std_set.upper_bound(5));
+  auto it = set.begin();
+  for (const auto &std_data : std_set) {
+    EXPECT_EQ(*it, std_data);
+    ++it;
+  }
+}
+
+TEST(MultisetTest, LoadSortedKeepsDuplicates) {
+  std::vector<int> sorted{1, 1, 2, 3, 3, 3, 7};
+  s21::S21Multiset<int> set;
+  set.load_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(set.size(), sorted.size());
+  EXPECT_EQ(set.count(3), 3U);
+  set.insert(3);
+  EXPECT_EQ(set.count(3), 4U);
+  auto it = set.begin();
+  EXPECT_EQ(*it, 1);
+}
+
+TEST(MultisetTest, MergeRelinksEveryNode) {
+  auto arena = std::make_shared<s21::S21Multiset<int>::arena_type>();
+  s21::S21Multiset<int> a(arena);
+  s21::S21Multiset<int> b(arena);
+  for (int i = 0; i < 100; i++) {
+    a.insert(i % 10);
+    b.insert(i % 7);
+  }
+  auto capacity = arena->capacity();
+  a.merge(b);
+  EXPECT_EQ(arena->capacity(), capacity);
+  EXPECT_EQ(a.size(), 200U);
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(a.count(3), 24U);
+  auto handle = a.extract(a.find(3));
+  EXPECT_EQ(a.count(3), 23U);
+  a.insert(std::move(handle));
+  EXPECT_EQ(a.count(3), 24U);
+}
+
+TEST(MultisetTest, HintedInsertKeepsDuplicatesOrdered) {
+  s21::S21Multiset<int> s{1, 3, 3, 5};
+  s.insert(s.end(), 5);
+  s.insert(s.begin(), 3);
+  s.emplace_hint(s.find(5), 4);
+  std::multiset<int> expected{1, 3, 3, 3, 4, 5, 5};
+  ASSERT_EQ(s.size(), expected.size());
+  auto it = s.begin();
+  for (int value : expected) {
+    EXPECT_EQ(*it, value);
+    ++it;
+  }
+  EXPECT_EQ(s.count(3), 3U);
+}
+
+TEST(MultisetTests, EraseRangeTakesEveryDuplicate) {
+  s21::S21Multiset<int> s{5, 1, 3, 3, 3, 4, 5, 2, 3};
+  int visited = 0;
+  s.for_each_in_range(3, 5, [&visited](int) { visited++; });
+  EXPECT_EQ(visited, 5);
+  EXPECT_EQ(s.erase_range(3, 5), 5U);
+  EXPECT_EQ(s.size(), 4U);
+  EXPECT_EQ(s.count(3), 0U);
+  EXPECT_EQ(s.count(5), 2U);
+  auto it = s.erase(s.lower_bound(5), s.end());
+  EXPECT_TRUE(it == s.end());
+  EXPECT_EQ(*--s.end(), 2);
+}
+
+TEST(MultisetTests, HoldsMoveOnlyValues) {
+  s21::S21Multiset<std::unique_ptr<int>,
+                   bool (*)(const std::unique_ptr<int> &,
+                            const std::unique_ptr<int> &)>
+      set([](const std::unique_ptr<int> &a, const std::unique_ptr<int> &b) {
+        return *a < *b;
+      });
+  set.insert(std::make_unique<int>(2));
+  set.emplace(new int(1));
+  set.emplace(new int(2));
+  set.emplace_hint(set.end(), new int(3));
+  std::vector<int> values;
+  for (const auto &p : set) {
+    values.push_back(*p);
+  }
+  EXPECT_EQ(values, (std::vector<int>{1, 2, 2, 3}));
+}
+
+TEST(MultisetTests, FindManyLandsOnFirstDuplicate) {
+  s21::S21Multiset<int> set;
+  for (int i = 0; i < 300; i++) {
+    set.insert(i % 37);
+  }
+  std::vector<int> keys = {36, 0, 50, 12, 12, -1, 5};
+  std::vector<decltype(set.begin())> found;
+  set.find_many(keys.begin(), keys.end(), std::back_inserter(found));
+  ASSERT_EQ(found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(found[i], set.find(keys[i]));
+    EXPECT_EQ(found[i], set.contains(keys[i]) ? set.lower_bound(keys[i])
+                                               : set.end());
+  }
+}
+
+TEST(MultisetTests, InsertSortedKeepsEveryDuplicate) {
+  s21::S21Multiset<int> set = {1, 3, 3, 7};
+  std::multiset<int> reference = {1, 3, 3, 7};
+  std::vector<int> batch = {0, 1, 3, 3, 4, 7, 7, 9};
+  EXPECT_EQ(set.insert_sorted(batch.begin(), batch.end()), batch.size());
+  reference.insert(batch.begin(), batch.end());
+  EXPECT_TRUE(std::equal(set.begin(), set.end(), reference.begin(),
+                         reference.end()));
+  EXPECT_EQ(set.count(3), 4U);
+  EXPECT_EQ(set.count(7), 3U);
+  for (int i = 10; i < 1000; i++) {
+    set.insert(i);
+  }
+  std::vector<int> run = {3, 500, 500};
+  set.insert_sorted(run.begin(), run.end());
+  EXPECT_EQ(set.count(3), 5U);
+  EXPECT_EQ(set.count(500), 3U);
+  EXPECT_EQ(set.size(), 1005U);
+}
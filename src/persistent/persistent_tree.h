@@ -0,0 +1,695 @@
+#ifndef CPP2_S21_CONTAINERS_2_PERSISTENT_PERSISTENT_TREE_H_
+#define CPP2_S21_CONTAINERS_2_PERSISTENT_PERSISTENT_TREE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../binary_search_tree/binary_search_tree.h"
+#include "../btree/btree.h"
+
+namespace s21 {
+
+// AVL tree whose nodes are immutable once shared. Nodes carry an atomic
+// reference count and have no parent pointers, so any number of trees can
+// point at the same subtree: copying a tree is O(1) and a mutation copies
+// only the nodes on its search path that are reachable from another tree.
+// Nodes owned by this tree alone are updated in place, so a writer that
+// keeps no snapshots allocates no more than an ordinary tree.
+//
+// Distinct trees sharing nodes can be used from different threads; one
+// tree object is no more thread-safe than any other container.
+template <typename Key, typename Value, typename KeyOfValue,
+          typename Compare = std::less<Key>>
+class PersistentTree {
+ public:
+  class Iterator;
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  PersistentTree() noexcept = default;
+  explicit PersistentTree(const Compare &comp) noexcept : comp_(comp) {}
+  PersistentTree(std::initializer_list<value_type> const &items);
+  PersistentTree(const PersistentTree &another) noexcept;
+  PersistentTree(PersistentTree &&another) noexcept;
+  ~PersistentTree() { release_(root_); }
+  PersistentTree &operator=(const PersistentTree &another) noexcept;
+  PersistentTree &operator=(PersistentTree &&another) noexcept;
+
+  PersistentTree snapshot() const noexcept {
+    return *this;
+  }  // O(1) copy sharing every node with this tree
+  template <typename InputIt>
+  void load_sorted(InputIt first, InputIt last);
+
+  Iterator begin() const noexcept;
+  Iterator end() const noexcept { return Iterator(root_); }
+  bool empty() const noexcept { return root_ == nullptr; }
+  size_type size() const noexcept { return count_(root_); }
+  size_type max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(node);
+  }
+  key_compare key_comp() const { return comp_; }
+
+  std::pair<Iterator, bool> insert(const value_type &value);
+  std::pair<Iterator, bool> insert(value_type &&value);
+  std::pair<Iterator, bool> insert_or_assign(const value_type &value);
+  size_type erase(const key_type &key);
+  void clear() noexcept;
+  void swap(PersistentTree &another) noexcept;
+
+  Iterator find(const key_type &key) const noexcept;
+  bool contains(const key_type &key) const noexcept;
+  size_type count(const key_type &key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+  Iterator lower_bound(const key_type &key) const noexcept;
+  Iterator upper_bound(const key_type &key) const noexcept;
+  const value_type &nth(size_type index) const;
+  size_type rank(const key_type &key) const noexcept;
+  bool shares_root_with(const PersistentTree &another) const noexcept {
+    return root_ != nullptr && root_ == another.root_;
+  }  // true while neither tree has been modified since a snapshot
+
+ protected:
+  struct node {
+    template <typename... Args>
+    explicit node(Args &&...args) : value(std::forward<Args>(args)...) {}
+    std::atomic<size_type> refs{1};
+    node *left = nullptr;
+    node *right = nullptr;
+    size_type count = 1;
+    int height = 1;
+    Value value;
+  };
+
+  node *root_ = nullptr;
+  Compare comp_ = Compare();
+
+  bool less_(const key_type &a, const key_type &b) const {
+    return compare_less(comp_, a, b);
+  }
+  static const key_type &key_of_(const node *n) noexcept {
+    return KeyOfValue()(n->value);
+  }
+  static size_type count_(const node *n) noexcept {
+    return n ? n->count : 0;
+  }
+  static int height_(const node *n) noexcept { return n ? n->height : 0; }
+  static void update_(node *n) noexcept;
+  static node *retain_(node *n) noexcept;
+  static void release_(node *n) noexcept;
+  static void unique_(node *&slot);
+  static void rotate_left_(node *&slot);
+  static void rotate_right_(node *&slot);
+  static void balance_(node *&slot);
+  static node *build_(Value *values, size_type count);
+
+  template <typename Arg>
+  void insert_(node *&slot, Arg &&value);
+  void assign_(node *&slot, const value_type &value);
+  void erase_(node *&slot, const key_type &key);
+  static void remove_min_(node *&slot, node *&min);
+  static void replace_(node *&slot, node *successor) noexcept;
+  template <typename Arg>
+  std::pair<Iterator, bool> emplace_(Arg &&value);
+};
+
+// Keeps the path from the root, so the tree needs no parent pointers and
+// stepping in either direction is amortized O(1). An empty path is end().
+// Any mutation of the tree invalidates its iterators; iterate a snapshot
+// to read while writing.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+class PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator {
+ public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Value *;
+  using reference = const Value &;
+
+  Iterator() noexcept = default;
+  reference operator*() const noexcept { return path_[depth_ - 1]->value; }
+  pointer operator->() const noexcept { return &path_[depth_ - 1]->value; }
+  Iterator &operator++() noexcept;
+  Iterator operator++(int) noexcept {
+    Iterator old = *this;
+    ++*this;
+    return old;
+  }
+  Iterator &operator--() noexcept;
+  Iterator operator--(int) noexcept {
+    Iterator old = *this;
+    --*this;
+    return old;
+  }
+  bool operator==(const Iterator &other) const noexcept {
+    return current_() == other.current_();
+  }
+  bool operator!=(const Iterator &other) const noexcept {
+    return !(*this == other);
+  }
+
+ private:
+  friend class PersistentTree;
+  // An AVL tree of height 96 holds more nodes than fit in memory.
+  static constexpr size_type max_height = 96;
+
+  explicit Iterator(const node *root) noexcept : root_(root) {}
+  const node *current_() const noexcept {
+    return depth_ ? path_[depth_ - 1] : nullptr;
+  }
+  void push_(const node *n) noexcept { path_[depth_++] = n; }
+
+  const node *root_ = nullptr;
+  std::array<const node *, max_height> path_;
+  size_type depth_ = 0;
+};
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator &
+PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator::operator++()
+    noexcept {
+  if (depth_ == 0) {
+    return *this;
+  }
+  const node *n = path_[depth_ - 1];
+  if (n->right) {
+    for (n = n->right; n; n = n->left) {
+      push_(n);
+    }
+    return *this;
+  }
+  const node *child = nullptr;
+  do {
+    child = path_[--depth_];
+  } while (depth_ > 0 && path_[depth_ - 1]->right == child);
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator &
+PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator::operator--()
+    noexcept {
+  if (depth_ == 0) {
+    for (const node *n = root_; n; n = n->right) {
+      push_(n);
+    }
+    return *this;
+  }
+  const node *n = path_[depth_ - 1];
+  if (n->left) {
+    for (n = n->left; n; n = n->right) {
+      push_(n);
+    }
+    return *this;
+  }
+  const node *child = nullptr;
+  do {
+    child = path_[--depth_];
+  } while (depth_ > 0 && path_[depth_ - 1]->left == child);
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+PersistentTree<Key, Value, KeyOfValue, Compare>::PersistentTree(
+    std::initializer_list<value_type> const &items) {
+  for (const value_type &item : items) {
+    insert(item);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+PersistentTree<Key, Value, KeyOfValue, Compare>::PersistentTree(
+    const PersistentTree &another) noexcept
+    : root_(retain_(another.root_)), comp_(another.comp_) {}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+PersistentTree<Key, Value, KeyOfValue, Compare>::PersistentTree(
+    PersistentTree &&another) noexcept
+    : root_(another.root_), comp_(another.comp_) {
+  another.root_ = nullptr;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+PersistentTree<Key, Value, KeyOfValue, Compare> &
+PersistentTree<Key, Value, KeyOfValue, Compare>::operator=(
+    const PersistentTree &another) noexcept {
+  node *old = root_;
+  root_ = retain_(another.root_);
+  comp_ = another.comp_;
+  release_(old);
+  return *this;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+PersistentTree<Key, Value, KeyOfValue, Compare> &
+PersistentTree<Key, Value, KeyOfValue, Compare>::operator=(
+    PersistentTree &&another) noexcept {
+  if (this != &another) {
+    release_(root_);
+    root_ = another.root_;
+    comp_ = another.comp_;
+    another.root_ = nullptr;
+  }
+  return *this;
+}
+
+// Builds a perfectly balanced tree in O(n) from values that are already
+// sorted by key and unique; throws std::invalid_argument otherwise.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+template <typename InputIt>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::load_sorted(
+    InputIt first, InputIt last) {
+  std::vector<Value> values(first, last);
+  for (size_type i = 1; i < values.size(); i++) {
+    if (!less_(KeyOfValue()(values[i - 1]), KeyOfValue()(values[i]))) {
+      throw std::invalid_argument("values are not sorted and unique");
+    }
+  }
+  node *built = build_(values.data(), values.size());
+  release_(root_);
+  root_ = built;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator
+PersistentTree<Key, Value, KeyOfValue, Compare>::begin() const noexcept {
+  Iterator it(root_);
+  for (const node *n = root_; n; n = n->left) {
+    it.push_(n);
+  }
+  return it;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+std::pair<typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+PersistentTree<Key, Value, KeyOfValue, Compare>::insert(
+    const value_type &value) {
+  return emplace_(value);
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+std::pair<typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+PersistentTree<Key, Value, KeyOfValue, Compare>::insert(value_type &&value) {
+  return emplace_(std::move(value));
+}
+
+// A present key is detected before anything is copied, so a failed insert
+// leaves all sharing intact.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+template <typename Arg>
+std::pair<typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+PersistentTree<Key, Value, KeyOfValue, Compare>::emplace_(Arg &&value) {
+  const key_type &key = KeyOfValue()(value);
+  Iterator found = find(key);
+  if (found != end()) {
+    return {found, false};
+  }
+  Key copy = key;
+  insert_(root_, std::forward<Arg>(value));
+  return {find(copy), true};
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+std::pair<typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator,
+          bool>
+PersistentTree<Key, Value, KeyOfValue, Compare>::insert_or_assign(
+    const value_type &value) {
+  const key_type &key = KeyOfValue()(value);
+  if (!contains(key)) {
+    return insert(value);
+  }
+  assign_(root_, value);
+  return {find(key), false};
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::size_type
+PersistentTree<Key, Value, KeyOfValue, Compare>::erase(const key_type &key) {
+  if (!contains(key)) {
+    return 0;
+  }
+  erase_(root_, key);
+  return 1;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::clear() noexcept {
+  release_(root_);
+  root_ = nullptr;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::swap(
+    PersistentTree &another) noexcept {
+  std::swap(root_, another.root_);
+  std::swap(comp_, another.comp_);
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator
+PersistentTree<Key, Value, KeyOfValue, Compare>::find(
+    const key_type &key) const noexcept {
+  Iterator it = lower_bound(key);
+  if (it != end() && less_(key, KeyOfValue()(*it))) {
+    return end();
+  }
+  return it;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+bool PersistentTree<Key, Value, KeyOfValue, Compare>::contains(
+    const key_type &key) const noexcept {
+  const node *n = root_;
+  while (n) {
+    if (less_(key, key_of_(n))) {
+      n = n->left;
+    } else if (less_(key_of_(n), key)) {
+      n = n->right;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The path is cut back to the last node at which the search turned left:
+// that node is the answer, everything below it is smaller than key.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator
+PersistentTree<Key, Value, KeyOfValue, Compare>::lower_bound(
+    const key_type &key) const noexcept {
+  Iterator it(root_);
+  size_type answer = 0;
+  for (const node *n = root_; n;) {
+    it.push_(n);
+    if (less_(key_of_(n), key)) {
+      n = n->right;
+    } else {
+      answer = it.depth_;
+      n = n->left;
+    }
+  }
+  it.depth_ = answer;
+  return it;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::Iterator
+PersistentTree<Key, Value, KeyOfValue, Compare>::upper_bound(
+    const key_type &key) const noexcept {
+  Iterator it(root_);
+  size_type answer = 0;
+  for (const node *n = root_; n;) {
+    it.push_(n);
+    if (less_(key, key_of_(n))) {
+      answer = it.depth_;
+      n = n->left;
+    } else {
+      n = n->right;
+    }
+  }
+  it.depth_ = answer;
+  return it;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+const typename PersistentTree<Key, Value, KeyOfValue, Compare>::value_type &
+PersistentTree<Key, Value, KeyOfValue, Compare>::nth(size_type index) const {
+  if (index >= size()) {
+    throw std::out_of_range("index is out of range");
+  }
+  const node *n = root_;
+  while (index != count_(n->left)) {
+    if (index < count_(n->left)) {
+      n = n->left;
+    } else {
+      index -= count_(n->left) + 1;
+      n = n->right;
+    }
+  }
+  return n->value;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::size_type
+PersistentTree<Key, Value, KeyOfValue, Compare>::rank(
+    const key_type &key) const noexcept {
+  size_type before = 0;
+  for (const node *n = root_; n;) {
+    if (less_(key_of_(n), key)) {
+      before += count_(n->left) + 1;
+      n = n->right;
+    } else {
+      n = n->left;
+    }
+  }
+  return before;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::update_(
+    node *n) noexcept {
+  n->count = count_(n->left) + count_(n->right) + 1;
+  n->height = std::max(height_(n->left), height_(n->right)) + 1;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::node *
+PersistentTree<Key, Value, KeyOfValue, Compare>::retain_(node *n) noexcept {
+  if (n) {
+    n->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  return n;
+}
+
+// The acquire half of the decrement orders every read another owner made
+// before letting go ahead of the delete or of an in-place update.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::release_(
+    node *n) noexcept {
+  while (n && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    release_(n->left);
+    node *right = n->right;
+    delete n;
+    n = right;
+  }
+}
+
+// Makes slot point to a node the caller may modify: the same node when
+// nobody else holds it, otherwise a copy whose children are shared with
+// the original. Nothing changes if the copy throws.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::unique_(node *&slot) {
+  if (slot->refs.load(std::memory_order_acquire) == 1) {
+    return;
+  }
+  node *copy = new node(slot->value);
+  copy->left = retain_(slot->left);
+  copy->right = retain_(slot->right);
+  copy->count = slot->count;
+  copy->height = slot->height;
+  release_(slot);
+  slot = copy;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::rotate_left_(
+    node *&slot) {
+  unique_(slot->right);
+  node *pivot = slot->right;
+  slot->right = pivot->left;
+  pivot->left = slot;
+  update_(slot);
+  update_(pivot);
+  slot = pivot;
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::rotate_right_(
+    node *&slot) {
+  unique_(slot->left);
+  node *pivot = slot->left;
+  slot->left = pivot->right;
+  pivot->right = slot;
+  update_(slot);
+  update_(pivot);
+  slot = pivot;
+}
+
+// slot must already be unique. After an insert the heavy side lies on the
+// search path and is unique too, so only erase can copy here; a failed
+// copy leaves a valid, merely less balanced tree.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::balance_(node *&slot) {
+  update_(slot);
+  int factor = height_(slot->left) - height_(slot->right);
+  if (factor > 1) {
+    if (height_(slot->left->left) < height_(slot->left->right)) {
+      unique_(slot->left);
+      rotate_left_(slot->left);
+    }
+    rotate_right_(slot);
+  } else if (factor < -1) {
+    if (height_(slot->right->right) < height_(slot->right->left)) {
+      unique_(slot->right);
+      rotate_right_(slot->right);
+    }
+    rotate_left_(slot);
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+typename PersistentTree<Key, Value, KeyOfValue, Compare>::node *
+PersistentTree<Key, Value, KeyOfValue, Compare>::build_(Value *values,
+                                                        size_type count) {
+  if (count == 0) {
+    return nullptr;
+  }
+  size_type middle = count / 2;
+  node *left = build_(values, middle);
+  node *right = nullptr;
+  node *n = nullptr;
+  try {
+    right = build_(values + middle + 1, count - middle - 1);
+    n = new node(std::move(values[middle]));
+  } catch (...) {
+    release_(left);
+    release_(right);
+    throw;
+  }
+  n->left = left;
+  n->right = right;
+  update_(n);
+  return n;
+}
+
+// The key is known to be absent, so every node on the path changes. If a
+// copy throws on the way down, the nodes already made unique keep their
+// counts right on the way up.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+template <typename Arg>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::insert_(node *&slot,
+                                                              Arg &&value) {
+  if (slot == nullptr) {
+    slot = new node(std::forward<Arg>(value));
+    return;
+  }
+  unique_(slot);
+  try {
+    if (less_(KeyOfValue()(value), key_of_(slot))) {
+      insert_(slot->left, std::forward<Arg>(value));
+    } else {
+      insert_(slot->right, std::forward<Arg>(value));
+    }
+  } catch (...) {
+    update_(slot);
+    throw;
+  }
+  balance_(slot);
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::assign_(
+    node *&slot, const value_type &value) {
+  unique_(slot);
+  const key_type &key = KeyOfValue()(value);
+  if (less_(key, key_of_(slot))) {
+    assign_(slot->left, value);
+  } else if (less_(key_of_(slot), key)) {
+    assign_(slot->right, value);
+  } else {
+    slot->value = value;
+  }
+}
+
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::erase_(
+    node *&slot, const key_type &key) {
+  unique_(slot);
+  try {
+    if (less_(key, key_of_(slot))) {
+      erase_(slot->left, key);
+    } else if (less_(key_of_(slot), key)) {
+      erase_(slot->right, key);
+    } else if (slot->right == nullptr) {
+      replace_(slot, nullptr);
+      return;
+    } else {
+      node *successor = nullptr;
+      try {
+        remove_min_(slot->right, successor);
+      } catch (...) {
+        if (successor) {
+          replace_(slot, successor);
+        }
+        throw;
+      }
+      replace_(slot, successor);
+    }
+  } catch (...) {
+    if (slot) {
+      update_(slot);
+    }
+    throw;
+  }
+  balance_(slot);
+}
+
+// Detaches the smallest node under slot as a unique, childless node. min
+// is set before any rebalancing, so the caller gets it even on a throw.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::remove_min_(
+    node *&slot, node *&min) {
+  unique_(slot);
+  if (slot->left == nullptr) {
+    min = slot;
+    slot = min->right;
+    min->right = nullptr;
+    return;
+  }
+  try {
+    remove_min_(slot->left, min);
+  } catch (...) {
+    update_(slot);
+    throw;
+  }
+  balance_(slot);
+}
+
+// Puts successor (or the left child when there is none) in place of the
+// unique node in slot and frees that node.
+template <typename Key, typename Value, typename KeyOfValue, typename Compare>
+void PersistentTree<Key, Value, KeyOfValue, Compare>::replace_(
+    node *&slot, node *successor) noexcept {
+  node *erased = slot;
+  if (successor) {
+    successor->left = erased->left;
+    successor->right = erased->right;
+    update_(successor);
+  } else {
+    successor = erased->left;
+  }
+  erased->left = erased->right = nullptr;
+  release_(erased);
+  slot = successor;
+}
+
+}  // namespace s21
+
+#endif
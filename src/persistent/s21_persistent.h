@@ -0,0 +1,63 @@
+#ifndef CPP2_S21_CONTAINERS_2_PERSISTENT_S21_PERSISTENT_H_
+#define CPP2_S21_CONTAINERS_2_PERSISTENT_S21_PERSISTENT_H_
+
+#include "../map/s21_map.h"
+#include "../set/s21_set.h"
+#include "persistent_tree.h"
+
+namespace s21 {
+
+template <typename T, typename Compare = std::less<T>>
+class PersistentSet
+    : public PersistentTree<T, T, BTreeIdentity, Compare> {
+  using Tree = PersistentTree<T, T, BTreeIdentity, Compare>;
+
+ public:
+  using Tree::Tree;
+  explicit PersistentSet(const S21Set<T, Compare> &set)
+      : Tree(set.value_comp()) {
+    this->load_sorted(set.begin(), set.end());
+  }  // shares nothing with set; later snapshots are O(1)
+
+  PersistentSet snapshot() const noexcept { return *this; }
+};
+
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class PersistentMap
+    : public PersistentTree<Key, std::pair<Key, T>, BTreeSelectFirst,
+                            Compare> {
+  using Tree =
+      PersistentTree<Key, std::pair<Key, T>, BTreeSelectFirst, Compare>;
+
+ public:
+  using mapped_type = T;
+  using typename Tree::iterator;
+  using typename Tree::value_type;
+  using Tree::insert;
+  using Tree::insert_or_assign;
+  using Tree::Tree;
+  explicit PersistentMap(const S21Map<Key, T, Compare> &map)
+      : Tree(map.key_comp()) {
+    this->load_sorted(map.begin(), map.end());
+  }  // shares nothing with map; later snapshots are O(1)
+
+  PersistentMap snapshot() const noexcept { return *this; }
+
+  const T &at(const Key &key) const {
+    iterator it = this->find(key);
+    if (it == this->end()) {
+      throw std::out_of_range("key not found");
+    }
+    return it->second;
+  }  // access a specified element with bounds checking
+  std::pair<iterator, bool> insert(const Key &key, const T &obj) {
+    return insert(value_type(key, obj));
+  }  // inserts a value by key unless the key is already present
+  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj) {
+    return insert_or_assign(value_type(key, obj));
+  }  // inserts an element or replaces the value of the one with that key
+};
+
+}  // namespace s21
+
+#endif
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../s21_containersplus.h"
+
+template <typename Tree, typename Reference>
+void ExpectSameContents(const Tree &tree, const Reference &reference) {
+  ASSERT_EQ(tree.size(), reference.size());
+  auto it = tree.begin();
+  for (const auto &value : reference) {
+    ASSERT_TRUE(it != tree.end());
+    ASSERT_EQ(*it, value);
+    ++it;
+  }
+  ASSERT_TRUE(it == tree.end());
+}
+
+TEST(PersistentTests, SnapshotsAreIsolated) {
+  s21::PersistentMap<int, std::string> config = {{1, "a"}, {2, "b"}};
+  s21::PersistentMap<int, std::string> view = config.snapshot();
+  EXPECT_TRUE(view.shares_root_with(config));
+  config.insert_or_assign(2, "B");
+  config.insert(3, "c");
+  config.erase(1);
+  EXPECT_FALSE(view.shares_root_with(config));
+  EXPECT_EQ(view.size(), 2u);
+  EXPECT_EQ(view.at(1), "a");
+  EXPECT_EQ(view.at(2), "b");
+  EXPECT_FALSE(view.contains(3));
+  EXPECT_EQ(config.at(2), "B");
+  EXPECT_EQ(config.at(3), "c");
+  EXPECT_THROW(config.at(1), std::out_of_range);
+  EXPECT_FALSE(config.insert(3, "x").second);
+}
+
+TEST(PersistentTests, RandomEditsMatchEverySnapshot) {
+  std::mt19937 random(3);
+  s21::PersistentSet<int> set;
+  std::set<int> reference;
+  std::vector<s21::PersistentSet<int>> snapshots;
+  std::vector<std::set<int>> expected;
+  for (int step = 0; step < 20000; step++) {
+    int key = random() % 1000;
+    if (random() % 3 == 0) {
+      EXPECT_EQ(set.erase(key), reference.erase(key));
+    } else {
+      auto result = set.insert(key);
+      EXPECT_EQ(result.second, reference.insert(key).second);
+      EXPECT_EQ(*result.first, key);
+    }
+    if (step % 500 == 0) {
+      snapshots.push_back(set.snapshot());
+      expected.push_back(reference);
+    }
+  }
+  ExpectSameContents(set, reference);
+  for (size_t i = 0; i < snapshots.size(); i++) {
+    ExpectSameContents(snapshots[i], expected[i]);
+  }
+  size_t index = 0;
+  for (int value : reference) {
+    ASSERT_EQ(set.nth(index), value);
+    ASSERT_EQ(set.rank(value), index++);
+  }
+  EXPECT_EQ(*set.lower_bound(500), *reference.lower_bound(500));
+  EXPECT_EQ(*set.upper_bound(500), *reference.upper_bound(500));
+  EXPECT_EQ(*--set.end(), *reference.rbegin());
+}
+
+TEST(PersistentTests, FromOrderedContainers) {
+  s21::S21Map<int, int> map;
+  for (int i = 0; i < 100; i++) {
+    map.insert(i, i * i);
+  }
+  s21::PersistentMap<int, int> frozen_map(map);
+  EXPECT_EQ(frozen_map.size(), 100u);
+  EXPECT_EQ(frozen_map.at(9), 81);
+  s21::S21Set<std::string> set = {"b", "a", "c"};
+  s21::PersistentSet<std::string> copy(set);
+  ExpectSameContents(copy, std::set<std::string>{"a", "b", "c"});
+  std::vector<int> unsorted = {2, 1};
+  s21::PersistentSet<int> bad;
+  EXPECT_THROW(bad.load_sorted(unsorted.begin(), unsorted.end()),
+               std::invalid_argument);
+}
+
+TEST(PersistentTests, ReadersKeepSnapshotsWhileWriterUpdates) {
+  s21::PersistentMap<int, int> table;
+  for (int i = 0; i < 1000; i++) {
+    table.insert(i, 0);
+  }
+  std::vector<std::thread> readers;
+  std::vector<long> sums(4, 0);
+  for (int version = 1; version <= 4; version++) {
+    s21::PersistentMap<int, int> view = table.snapshot();
+    readers.emplace_back([view, version, &sums] {
+      for (int pass = 0; pass < 20; pass++) {
+        long sum = 0;
+        for (const auto &entry : view) {
+          sum += entry.second;
+        }
+        sums[version - 1] = sum;
+      }
+    });
+    for (int i = 0; i < 1000; i++) {
+      table.insert_or_assign(i, version);
+    }
+  }
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  for (int version = 1; version <= 4; version++) {
+    EXPECT_EQ(sums[version - 1], 1000L * (version - 1));
+  }
+}
+
+struct Fragile {
+  static int copies_left;
+  int value;
+  Fragile(int v) : value(v) {}
+  Fragile(const Fragile &other) : value(other.value) {
+    if (--copies_left < 0) {
+      throw std::runtime_error("copy failed");
+    }
+  }
+  Fragile &operator=(const Fragile &) = default;
+  bool operator<(const Fragile &other) const { return value < other.value; }
+};
+int Fragile::copies_left = 1 << 30;
+
+TEST(PersistentTests, FailedCopyLeavesTreesValid) {
+  s21::PersistentSet<Fragile> set;
+  for (int i = 0; i < 200; i++) {
+    set.insert(Fragile(i));
+  }
+  for (int budget = 0; budget < 12; budget++) {
+    s21::PersistentSet<Fragile> view = set.snapshot();
+    std::vector<int> before;
+    for (const Fragile &item : view) {
+      before.push_back(item.value);
+    }
+    Fragile::copies_left = budget;
+    try {
+      set.erase(Fragile(budget * 7));
+      set.insert(Fragile(1000 + budget));
+    } catch (const std::runtime_error &) {
+    }
+    Fragile::copies_left = 1 << 30;
+    size_t count = 0;
+    int previous = -1;
+    for (const Fragile &item : set) {
+      EXPECT_LT(previous, item.value);
+      previous = item.value;
+      count++;
+    }
+    EXPECT_EQ(count, set.size());
+    ASSERT_EQ(view.size(), before.size());
+    auto it = before.begin();
+    for (const Fragile &item : view) {
+      EXPECT_EQ(item.value, *it++);
+    }
+  }
+}
@@ -2,6 +2,13 @@
 #define CPP2_S21_CONTAINERS_2_S21_CONTAINERSPLUS_H_
 
 #include "array/s21_array.h"
+#include "btree/s21_btree.h"
+#include "compact/s21_compact.h"
+#include "concurrent/s21_concurrent_map.h"
+#include "concurrent/s21_skip_list.h"
+#include "frozen/s21_frozen.h"
+#include "interval/s21_interval.h"
 #include "multiset/s21_multiset.h"
+#include "persistent/s21_persistent.h"
 
 #endif /* CPP2_S21_CONTAINERS_1_S21_CONTAINERSPLUS_H_*/
\ No newline at end of file
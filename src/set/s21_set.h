@@ -2,23 +2,31 @@
 #define CPP2_S21_CONTAINERS_2_SET_S21_SET_H_
 
 #include "../binary_search_tree/binary_search_tree.h"
-#include "../list/s21_list.h"
 
 namespace s21 {
 
-template <typename T>
-class S21Set : public s21::BinarySearchTree<T> {
+template <typename T, typename Compare = std::less<T>>
+class S21Set : public s21::BinarySearchTree<T, Compare> {
  public:
   using value_type = T;
-  using BinaryTree = BinarySearchTree<T>;
+  using key_compare = Compare;
+  using BinaryTree = BinarySearchTree<T, Compare>;
   using iterator = typename BinaryTree::iterator;
   using const_iterator = typename BinaryTree::ConstIterator;
   using size_type = size_t;
   using node = typename BinaryTree::node;
+  using arena_type = typename BinaryTree::arena_type;
+  using node_type = typename BinaryTree::node_type;
 
   S21Set() noexcept
       : BinaryTree::BinarySearchTree() {
   }  // default constructor, creates empty set
+  explicit S21Set(const Compare &comp) noexcept
+      : BinaryTree::BinarySearchTree(comp) {
+  }  // creates empty set ordered by comp
+  explicit S21Set(std::shared_ptr<arena_type> arena) noexcept
+      : BinaryTree::BinarySearchTree(std::move(arena)) {
+  }  // creates empty set allocating nodes from a shared arena
   S21Set(std::initializer_list<value_type> const &items)
       : BinaryTree::BinarySearchTree(items) {
   }  // initializer list constructor, creates the set initizialized using
@@ -28,36 +36,87 @@ class S21Set : public s21::BinarySearchTree<T> {
   S21Set(S21Set &&s)
       : BinaryTree::BinarySearchTree(std::move(s)) {}  // move constructor
   std::pair<iterator, bool> insert(const value_type &value) {
-    value_type t = value;
-    if (!this->contains(value)) {
-      return BinaryTree::insert(std::move(t));
-    } else {
-      return BinaryTree::insert(std::move(t), 0);
-    }
-  }
+    return this->insert_unique_(value);
+  }  // copies value into a new node only if it is not present yet
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return this->insert_unique_(std::move(value));
+  }  // moves value into a new node only if it is not present yet
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return BinaryTree::emplace(std::forward<Args>(args)...);
+  }  // constructs an element in place unless an equal one is present
+  std::pair<iterator, bool> insert(node_type &&handle) {
+    return BinaryTree::insert(std::move(handle));
+  }  // links an extracted node unless its value is already present
+  iterator insert(const_iterator hint, const value_type &value) {
+    return BinaryTree::insert(hint, value);
+  }  // inserts value, in O(1) comparisons when it belongs right before hint
+  iterator insert(const_iterator hint, value_type &&value) {
+    return BinaryTree::insert(hint, std::move(value));
+  }  // moves value in, using hint as the position
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return BinaryTree::emplace_hint(hint, std::forward<Args>(args)...);
+  }  // constructs an element in place, using hint as the position
   void merge(S21Set &other);  // splices nodes from another container
+  void unite(S21Set &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::unite, threads);
+  }  // adds the elements of other, relinking its nodes; other ends up empty
+  void intersect(S21Set &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::intersect, threads);
+  }  // keeps only the elements also present in other
+  void subtract(S21Set &&other, unsigned threads = 0) {
+    this->combine_with_(other, BinaryTree::set_operation::subtract, threads);
+  }  // drops the elements present in other
   S21Set &operator=(S21Set &&s) noexcept {
     BinaryTree::operator=(std::move(s));
     return *this;
   }  // assignment operator overload for moving object
-  S21Set &operator=(S21Set &s) {
+  S21Set &operator=(const S21Set &s) {
     BinaryTree::operator=(s);
     return *this;
-  }  // assignment operator overload for moving object
+  }  // assignment operator overload for copying object
 };
 
-template <typename T>
-void S21Set<T>::merge(S21Set &other) {
-  S21List<value_type> to_erase;
-  for (auto it = other.begin(); it != other.end(); it++) {
-    if (this->insert(std::move(*it)).second) {
-      // this->insert(std::move(*it), 1);
-      to_erase.push_front(*it);
-    }
-  }
-  for (auto it = to_erase.begin(); it != to_erase.end(); it++) {
-    other.erase(*it);
-  }
+template <typename T, typename Compare>
+void S21Set<T, Compare>::merge(S21Set &other) {
+  BinaryTree::merge(other);
+}
+
+// Set algebra on copies of a and b. Both copies are made in one arena so
+// the join-based combine can relink nodes freely; callers that no longer
+// need their sets should use unite/intersect/subtract to skip the copies.
+template <typename T, typename Compare>
+S21Set<T, Compare> set_union(const S21Set<T, Compare> &a,
+                             const S21Set<T, Compare> &b,
+                             unsigned threads = 0) {
+  S21Set<T, Compare> result(a);
+  S21Set<T, Compare> other(result.arena());
+  other = b;
+  result.unite(std::move(other), threads);
+  return result;
+}
+
+template <typename T, typename Compare>
+S21Set<T, Compare> set_intersection(const S21Set<T, Compare> &a,
+                                    const S21Set<T, Compare> &b,
+                                    unsigned threads = 0) {
+  S21Set<T, Compare> result(a);
+  S21Set<T, Compare> other(result.arena());
+  other = b;
+  result.intersect(std::move(other), threads);
+  return result;
+}
+
+template <typename T, typename Compare>
+S21Set<T, Compare> set_difference(const S21Set<T, Compare> &a,
+                                  const S21Set<T, Compare> &b,
+                                  unsigned threads = 0) {
+  S21Set<T, Compare> result(a);
+  S21Set<T, Compare> other(result.arena());
+  other = b;
+  result.subtract(std::move(other), threads);
+  return result;
 }
 }  // namespace s21
 
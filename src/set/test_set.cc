@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+
 #include "../s21_containers.h"
 
 TEST(SetTests, DefaultConstructor) {
@@ -163,7 +170,7 @@ TEST(SetTests, AssignmentCopy) {
   S1.insert(25);
   s21::S21Set<int> S2;
   S2 = S1;
-  ASSERT_EQ(S2.size(), 4);
+  ASSERT_EQ(S2.size(), 3);
   ASSERT_EQ(S2.size(), S1.size());
 }
 
@@ -172,7 +179,7 @@ TEST(SetTests, AssignmentMove) {
   S1.insert(25);
   s21::S21Set<int> S2;
   S2 = std::move(S1);
-  ASSERT_EQ(S2.size(), 4);
+  ASSERT_EQ(S2.size(), 3);
   ASSERT_EQ(S1.size(), 0);
 }
 
@@ -191,4 +198,660 @@ TEST(SetTests, operator_move) {
   std_set_empty = std::move(std_set3);
   ASSERT_EQ(set_empty.size(), std_set_empty.size());
   ASSERT_EQ(set3.size(), std_set3.size());
-}
\ No newline at end of file
+}
+TEST(SetTests, SortedInsertStaysBalanced) {
+  class HeightProbe : public s21::S21Set<int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  HeightProbe s;
+  for (int i = 0; i < 4096; i++) {
+    s.insert(i);
+  }
+  ASSERT_EQ(s.size(), 4096U);
+  ASSERT_LE(s.height(), 18);
+  int expected = 0;
+  for (auto it = s.begin(); it != s.end(); ++it, ++expected) {
+    ASSERT_EQ(*it, expected);
+  }
+  for (int i = 0; i < 4096; i += 2) {
+    s.erase(i);
+  }
+  ASSERT_EQ(s.size(), 2048U);
+  ASSERT_LE(s.height(), 17);
+  EXPECT_FALSE(s.contains(100));
+  EXPECT_TRUE(s.contains(101));
+}
+
+TEST(SetTests, IterateBothDirections) {
+  s21::S21Set<int> s;
+  std::set<int> std_s;
+  for (int i = 0; i < 500; i++) {
+    s.insert((i * 37) % 500);
+    std_s.insert((i * 37) % 500);
+  }
+  auto it = s.begin();
+  for (auto std_it = std_s.begin(); std_it != std_s.end(); ++std_it, ++it) {
+    ASSERT_EQ(*it, *std_it);
+  }
+  EXPECT_EQ(it, s.end());
+  for (auto std_it = std_s.rbegin(); std_it != std_s.rend(); ++std_it) {
+    --it;
+    ASSERT_EQ(*it, *std_it);
+  }
+  EXPECT_EQ(it, s.begin());
+  s21::S21Set<int> empty;
+  EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(SetTests, EraseKeepsOrderAndSize) {
+  s21::S21Set<int> s;
+  std::set<int> std_s;
+  for (int i = 0; i < 1000; i++) {
+    s.insert((i * 7919) % 1000);
+    std_s.insert((i * 7919) % 1000);
+  }
+  for (int i = 0; i < 1000; i += 3) {
+    int victim = (i * 104729) % 1000;
+    s.erase(victim);
+    std_s.erase(victim);
+    ASSERT_EQ(s.size(), std_s.size());
+  }
+  auto it = s.begin();
+  for (const auto &std_data : std_s) {
+    ASSERT_EQ(*it, std_data);
+    ++it;
+  }
+  EXPECT_EQ(it, s.end());
+  while (!s.empty()) {
+    s.erase(s.begin());
+  }
+  EXPECT_EQ(s.begin(), s.end());
+}
+
+TEST(SetTests, CustomCompare) {
+  s21::S21Set<int, std::greater<int>> s{3, 1, 4, 1, 5, 9, 2, 6};
+  std::set<int, std::greater<int>> std_s{3, 1, 4, 1, 5, 9, 2, 6};
+  ASSERT_EQ(s.size(), std_s.size());
+  auto it = s.begin();
+  for (const auto &std_data : std_s) {
+    EXPECT_EQ(*it, std_data);
+    ++it;
+  }
+  EXPECT_TRUE(s.contains(9));
+  EXPECT_FALSE(s.contains(7));
+}
+
+struct Directed {
+  bool descending = false;
+  bool operator()(int a, int b) const { return descending ? b < a : a < b; }
+};
+
+// Each tree keeps ordering its own elements after a swap.
+TEST(SetTests, SwapExchangesStatefulComparators) {
+  s21::S21Set<int, Directed> ascending(Directed{false});
+  s21::S21Set<int, Directed> descending(Directed{true});
+  for (int i = 0; i < 5; i++) {
+    ascending.insert(i);
+    descending.insert(i);
+  }
+  ascending.swap(descending);
+  EXPECT_TRUE(ascending.contains(3));
+  EXPECT_TRUE(descending.contains(3));
+  ascending.insert(10);
+  descending.insert(10);
+  std::vector<int> down(ascending.begin(), ascending.end());
+  std::vector<int> up(descending.begin(), descending.end());
+  EXPECT_EQ(down, (std::vector<int>{10, 4, 3, 2, 1, 0}));
+  EXPECT_EQ(up, (std::vector<int>{0, 1, 2, 3, 4, 10}));
+}
+
+TEST(SetTests, ThreeWayCompare) {
+  using three_way = int (*)(const std::string &, const std::string &);
+  three_way by_length = [](const std::string &a, const std::string &b) {
+    return int(a.size()) - int(b.size());
+  };
+  s21::S21Set<std::string, three_way> s(by_length);
+  EXPECT_TRUE(s.insert("ccc").second);
+  EXPECT_TRUE(s.insert("a").second);
+  EXPECT_FALSE(s.insert("bbb").second);
+  EXPECT_TRUE(s.insert("dd").second);
+  ASSERT_EQ(s.size(), 3U);
+  auto it = s.begin();
+  EXPECT_EQ(*it, "a");
+  EXPECT_EQ(*++it, "dd");
+  EXPECT_EQ(*++it, "ccc");
+  EXPECT_TRUE(s.contains("zzz"));
+}
+
+TEST(SetTests, ArenaReusesFreedNodes) {
+  s21::S21Set<int> s;
+  for (int i = 0; i < 1000; i++) {
+    s.insert(i);
+  }
+  auto capacity = s.arena()->capacity();
+  EXPECT_EQ(s.arena()->live(), 1000U);
+  for (int i = 0; i < 1000; i += 2) {
+    s.erase(i);
+  }
+  EXPECT_EQ(s.arena()->live(), 500U);
+  for (int i = 1000; i < 1500; i++) {
+    s.insert(i);
+  }
+  EXPECT_EQ(s.arena()->capacity(), capacity);
+  s.clear();
+  EXPECT_EQ(s.arena()->capacity(), 0U);
+}
+
+TEST(SetTests, SharedArena) {
+  auto arena = std::make_shared<s21::S21Set<std::string>::arena_type>();
+  s21::S21Set<std::string> first(arena);
+  s21::S21Set<std::string> second(arena);
+  first.insert("one");
+  first.insert("two");
+  second.insert("three");
+  EXPECT_EQ(arena->live(), 3U);
+  first.clear();
+  EXPECT_EQ(arena->live(), 1U);
+  EXPECT_TRUE(second.contains("three"));
+  second.insert("four");
+  EXPECT_EQ(arena->live(), 2U);
+  EXPECT_EQ(second.size(), 2U);
+}
+
+TEST(SetTests, LoadSorted) {
+  class HeightProbe : public s21::S21Set<int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  std::vector<int> sorted;
+  for (int i = 0; i < 1023; i++) {
+    sorted.push_back(i);
+    sorted.push_back(i);
+  }
+  HeightProbe s;
+  s.insert(-1);
+  s.load_sorted(sorted.begin(), sorted.end());
+  ASSERT_EQ(s.size(), 1023U);
+  EXPECT_EQ(s.height(), 10);
+  EXPECT_FALSE(s.contains(-1));
+  int expected = 0;
+  for (auto it = s.begin(); it != s.end(); ++it, ++expected) {
+    ASSERT_EQ(*it, expected);
+  }
+  s.insert(2000);
+  s.erase(500);
+  EXPECT_EQ(s.size(), 1023U);
+  std::vector<int> unsorted{3, 1, 2};
+  EXPECT_THROW(s.load_sorted(unsorted.begin(), unsorted.end()),
+               std::invalid_argument);
+  EXPECT_EQ(s.size(), 1023U);
+  s.load(unsorted.begin(), unsorted.end());
+  EXPECT_EQ(s.size(), 3U);
+  EXPECT_EQ(*s.begin(), 1);
+}
+
+TEST(SetTests, MergeRelinksNodes) {
+  auto arena = std::make_shared<s21::S21Set<std::string>::arena_type>();
+  s21::S21Set<std::string> s1(arena);
+  s21::S21Set<std::string> s2(arena);
+  s1.insert("a");
+  s1.insert("c");
+  s2.insert("b");
+  s2.insert("c");
+  s2.insert("d");
+  const std::string *address_of_b = &*s2.find("b");
+  auto capacity = arena->capacity();
+  s1.merge(s2);
+  EXPECT_EQ(arena->capacity(), capacity);
+  EXPECT_EQ(arena->live(), 5U);
+  EXPECT_EQ(&*s1.find("b"), address_of_b);
+  EXPECT_EQ(s1.size(), 4U);
+  ASSERT_EQ(s2.size(), 1U);
+  EXPECT_EQ(*s2.begin(), "c");
+}
+
+TEST(SetTests, ExtractAndInsertNode) {
+  s21::S21Set<std::string> s1{"apple", "banana", "cherry"};
+  s21::S21Set<std::string> s2{"banana"};
+  auto handle = s1.extract(s1.find("banana"));
+  ASSERT_FALSE(handle.empty());
+  EXPECT_EQ(handle.value(), "banana");
+  EXPECT_EQ(s1.size(), 2U);
+  auto result = s2.insert(std::move(handle));
+  EXPECT_FALSE(result.second);
+  EXPECT_FALSE(handle.empty());
+  handle.value() = "date";
+  result = s2.insert(std::move(handle));
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(*result.first, "date");
+  EXPECT_TRUE(handle.empty());
+  EXPECT_EQ(s2.size(), 2U);
+  EXPECT_TRUE(s1.extract("kiwi").empty());
+}
+
+TEST(SetTests, ParallelSetAlgebra) {
+  class HeightProbe : public s21::S21Set<int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  auto same = [](const s21::S21Set<int> &s, const std::vector<int> &v) {
+    auto it = s.begin();
+    for (size_t i = 0; i < v.size(); i++, ++it) {
+      if (*it != v[i]) return false;
+    }
+    return it == s.end();
+  };
+  s21::S21Set<int> evens;
+  s21::S21Set<int> triples;
+  std::vector<int> a;
+  std::vector<int> b;
+  for (int i = 0; i < 120000; i++) {
+    if (i % 2 == 0) a.push_back(i);
+    if (i % 3 == 0) b.push_back(i);
+  }
+  evens.load_sorted(a.begin(), a.end());
+  triples.load_sorted(b.begin(), b.end());
+  std::vector<int> expected;
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                 std::back_inserter(expected));
+  HeightProbe result;
+  static_cast<s21::S21Set<int> &>(result) = s21::set_union(evens, triples, 4);
+  ASSERT_EQ(result.size(), expected.size());
+  EXPECT_LE(result.height(), 24);
+  EXPECT_TRUE(same(result, expected));
+  EXPECT_EQ(evens.size(), a.size());
+  expected.clear();
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+  auto both = s21::set_intersection(evens, triples, 4);
+  ASSERT_EQ(both.size(), expected.size());
+  EXPECT_TRUE(same(both, expected));
+  expected.clear();
+  std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                      std::back_inserter(expected));
+  evens.subtract(std::move(triples), 4);
+  ASSERT_EQ(evens.size(), expected.size());
+  EXPECT_TRUE(triples.empty());
+  EXPECT_TRUE(same(evens, expected));
+  EXPECT_EQ(*evens.find(expected[1000]), expected[1000]);
+}
+
+TEST(SetTests, RankSelectAndJumps) {
+  s21::S21Set<int> s;
+  std::vector<int> sorted;
+  for (int i = 0; i < 10000; i++) {
+    sorted.push_back(i * 3);
+  }
+  s.load_sorted(sorted.begin(), sorted.end());
+  auto page = s.nth(4000);
+  EXPECT_EQ(*page, 12000);
+  EXPECT_EQ(s.rank(12000), 4000U);
+  EXPECT_EQ(s.rank(12001), 4001U);
+  EXPECT_EQ(s.count_range(30, 60), 10U);
+  EXPECT_EQ(s.count_range(60, 30), 0U);
+  EXPECT_TRUE(s.nth(10000) == s.end());
+  auto later = page + 25;
+  EXPECT_EQ(*page, 12000);
+  EXPECT_EQ(*later, 12075);
+  EXPECT_EQ(later - page, 25);
+  EXPECT_EQ(*(later - 1), 12072);
+  EXPECT_EQ(s.end() - s.begin(), 10000);
+  EXPECT_EQ(std::distance(s.begin(), s.find(300)), 100);
+  EXPECT_TRUE(page + 6000 == s.end());
+  EXPECT_TRUE(page - 4001 == s.end());
+  EXPECT_EQ(*(s.end() - 1), 29997);
+  later -= 100;
+  EXPECT_EQ(*later, 11775);
+}
+
+TEST(SetTests, HintedInsert) {
+  s21::S21Set<int> s;
+  for (int i = 0; i < 1000; i++) {
+    auto it = s.insert(s.end(), i * 2);
+    ASSERT_EQ(*it, i * 2);
+    ASSERT_EQ(it - s.begin(), i);
+  }
+  for (int i = -1; i > -100; i--) {
+    s.insert(s.begin(), i);
+  }
+  auto near_ten = s.find(10);
+  EXPECT_EQ(*s.insert(near_ten, 9), 9);
+  EXPECT_EQ(*s.insert(near_ten, 10), 10);
+  EXPECT_EQ(*s.insert(near_ten, 1001), 1001);
+  EXPECT_EQ(*s.emplace_hint(s.end(), 5000), 5000);
+  EXPECT_EQ(s.size(), 1000U + 99U + 3U);
+  int previous = -1000;
+  for (auto it = s.begin(); it != s.end(); ++it) {
+    ASSERT_LT(previous, *it);
+    previous = *it;
+  }
+  EXPECT_EQ(*(s.end() - 1), 5000);
+}
+
+TEST(SetTests, CopyTakesOneBlock) {
+  s21::S21Set<int> s;
+  for (int i = 0; i < 70000; i++) {
+    s.insert((i * 7919) % 70001);
+  }
+  s21::S21Set<int> copy(s);
+  EXPECT_EQ(copy.arena()->capacity(), s.size());
+  EXPECT_EQ(copy.arena()->live(), s.size());
+  s21::S21Set<int> parallel;
+  parallel.insert(-1);
+  parallel.assign(s, 4);
+  for (const s21::S21Set<int> *t : {&copy, &parallel}) {
+    ASSERT_EQ(t->size(), s.size());
+    auto it = t->begin();
+    for (auto source = s.begin(); source != s.end(); ++source, ++it) {
+      ASSERT_EQ(*it, *source);
+    }
+    EXPECT_EQ(*t->nth(12345), *s.nth(12345));
+  }
+  copy = copy;
+  EXPECT_EQ(copy.size(), s.size());
+  copy.erase(copy.find(100));
+  copy.insert(100);
+  EXPECT_EQ(copy.size(), s.size());
+}
+
+TEST(SetTests, FailedCopyLeavesNoNodes) {
+  struct Fragile {
+    static int &copies_left() {
+      static int copies = 1 << 30;
+      return copies;
+    }
+    int value;
+    Fragile(int v) : value(v) {}
+    Fragile(const Fragile &other) : value(other.value) {
+      if (--copies_left() < 0) {
+        throw std::runtime_error("copy failed");
+      }
+    }
+    Fragile &operator=(const Fragile &) = default;
+    bool operator<(const Fragile &other) const { return value < other.value; }
+  };
+  s21::S21Set<Fragile> s;
+  for (int i = 0; i < 100; i++) {
+    s.insert(Fragile(i));
+  }
+  s21::S21Set<Fragile> copy;
+  Fragile::copies_left() = 60;
+  EXPECT_THROW(copy = s, std::runtime_error);
+  Fragile::copies_left() = 1 << 30;
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.arena()->live(), 0u);
+}
+
+TEST(SetTests, EraseRangesMatchStdSet) {
+  class HeightProbe : public s21::S21Set<int> {
+   public:
+    int height() const { return this->root_ ? this->root_->height : 0; }
+  };
+  HeightProbe s;
+  std::set<int> reference;
+  for (int i = 0; i < 5000; i++) {
+    s.insert(i * 3);
+    reference.insert(i * 3);
+  }
+  unsigned seed = 7;
+  while (reference.size() > 100) {
+    seed = seed * 1103515245 + 12345;
+    int low = static_cast<int>(seed % 15000);
+    int high = low + static_cast<int>(seed / 7 % 300);
+    auto first = reference.lower_bound(low);
+    auto last = reference.lower_bound(high);
+    size_t expected = std::distance(first, last);
+    reference.erase(first, last);
+    ASSERT_EQ(s.erase_range(low, high), expected);
+    ASSERT_EQ(s.size(), reference.size());
+    ASSERT_EQ(*s.begin(), *reference.begin());
+    ASSERT_EQ(*--s.end(), *reference.rbegin());
+  }
+  EXPECT_TRUE(std::equal(s.begin(), s.end(), reference.begin()));
+  EXPECT_LE(s.height(), 10);
+  for (size_t i = 0; i < s.size(); i++) {
+    ASSERT_EQ(s.rank(*s.nth(i)), i);
+  }
+  auto it = s.erase(s.nth(10), s.nth(20));
+  EXPECT_EQ(*it, *std::next(reference.begin(), 20));
+  EXPECT_EQ(s.size(), reference.size() - 10);
+  it = s.erase(s.nth(5), s.end());
+  EXPECT_TRUE(it == s.end());
+  EXPECT_EQ(s.size(), 5U);
+  EXPECT_EQ(s.erase_range(10, 0), 0U);
+  s.erase(s.begin(), s.end());
+  EXPECT_TRUE(s.empty());
+  EXPECT_TRUE(s.begin() == s.end());
+}
+
+TEST(SetTests, ForEachInRange) {
+  s21::S21Set<int> s{1, 3, 5, 7, 9, 11};
+  std::vector<int> seen;
+  s.for_each_in_range(3, 9, [&seen](int value) { seen.push_back(value); });
+  EXPECT_EQ(seen, (std::vector<int>{3, 5, 7}));
+  seen.clear();
+  s.for_each_in_range(12, 20, [&seen](int value) { seen.push_back(value); });
+  s.for_each_in_range(9, 3, [&seen](int value) { seen.push_back(value); });
+  EXPECT_TRUE(seen.empty());
+}
+
+struct PointeeLess {
+  bool operator()(const std::unique_ptr<int> &a,
+                  const std::unique_ptr<int> &b) const {
+    return *a < *b;
+  }
+};
+
+TEST(SetTests, HoldsMoveOnlyValues) {
+  s21::S21Set<std::unique_ptr<int>, PointeeLess> s;
+  EXPECT_TRUE(s.insert(std::make_unique<int>(3)).second);
+  EXPECT_TRUE(s.emplace(new int(1)).second);
+  auto duplicate = std::make_unique<int>(3);
+  EXPECT_FALSE(s.insert(std::move(duplicate)).second);
+  EXPECT_NE(duplicate, nullptr);
+  EXPECT_EQ(**s.emplace_hint(s.end(), std::make_unique<int>(5)), 5);
+  EXPECT_EQ(s.size(), 3U);
+  auto handle = s.extract(s.begin());
+  EXPECT_EQ(*handle.value(), 1);
+  std::vector<std::unique_ptr<int>> batch;
+  for (int i : {9, 7, 8}) {
+    batch.push_back(std::make_unique<int>(i));
+  }
+  s.load(std::make_move_iterator(batch.begin()),
+         std::make_move_iterator(batch.end()));
+  std::vector<int> values;
+  for (const auto &p : s) {
+    values.push_back(*p);
+  }
+  EXPECT_EQ(values, (std::vector<int>{7, 8, 9}));
+}
+
+TEST(SetTests, TransparentLookup) {
+  s21::S21Set<std::string, std::less<>> s = {"apple", "kiwi", "pear"};
+  std::string_view probe = "kiwi";
+  EXPECT_EQ(*s.find(probe), "kiwi");
+  EXPECT_EQ(s.find(std::string_view("fig")), s.end());
+  EXPECT_TRUE(s.contains(probe));
+  EXPECT_FALSE(s.contains("plum"));
+  EXPECT_EQ(s.count(probe), 1U);
+  EXPECT_EQ(*s.lower_bound(std::string_view("banana")), "kiwi");
+  EXPECT_EQ(*s.upper_bound(probe), "pear");
+  EXPECT_EQ(s.upper_bound(std::string_view("pear")), s.end());
+  auto range = s.equal_range(probe);
+  EXPECT_EQ(range.second - range.first, 1);
+  EXPECT_EQ(range.first - s.begin(), 1);
+}
+
+TEST(SetTests, InsertSortedMatchesInsert) {
+  std::mt19937 random(3);
+  s21::S21Set<int> s;
+  std::set<int> reference;
+  for (int i = 0; i < 5000; i++) {
+    int value = static_cast<int>(random() % 20000);
+    s.insert(value);
+    reference.insert(value);
+  }
+  // A short run is inserted node by node, a long one merged and rebuilt.
+  std::vector<int> batch;
+  for (int length : {100, 3000}) {
+    batch.clear();
+    for (int i = 0; i < length; i++) {
+      batch.push_back(static_cast<int>(random() % 25000));
+    }
+    std::sort(batch.begin(), batch.end());
+    std::vector<bool> inserted;
+    s.insert_sorted(batch.begin(), batch.end(), std::back_inserter(inserted));
+    ASSERT_EQ(inserted.size(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      EXPECT_EQ(inserted[i], reference.insert(batch[i]).second);
+    }
+    ASSERT_EQ(s.size(), reference.size());
+    size_t index = 0;
+    for (int value : reference) {
+      ASSERT_EQ(*s.nth(index), value);
+      ASSERT_EQ(s.rank(value), index);
+      index++;
+    }
+  }
+  std::vector<int> unsorted = {1, 3, 2};
+  EXPECT_THROW(s.insert_sorted(unsorted.begin(), unsorted.end()),
+               std::invalid_argument);
+  EXPECT_EQ(s.size(), reference.size());
+  s21::S21Set<int> empty;
+  EXPECT_EQ(empty.insert_sorted(batch.begin(), batch.end()),
+            std::set<int>(batch.begin(), batch.end()).size());
+}
+
+struct ThrowsOn13 {
+  int value;
+  explicit ThrowsOn13(int v) : value(v) {}
+  ThrowsOn13(const ThrowsOn13 &other) : value(other.value) {
+    if (value % 1000 == 13) {
+      throw std::runtime_error("copy");
+    }
+  }
+  ThrowsOn13 &operator=(const ThrowsOn13 &) = default;
+  bool operator<(const ThrowsOn13 &other) const { return value < other.value; }
+};
+
+// A long run is merged all or nothing; a short one keeps what was placed
+// before the throw, and the reported results match either way.
+TEST(SetTests, InsertSortedReportsOnlyWhatItInserted) {
+  s21::S21Set<ThrowsOn13> s;
+  s.insert(ThrowsOn13(1));
+  s.insert(ThrowsOn13(2));
+  auto make_run = [](std::initializer_list<int> values) {
+    std::vector<ThrowsOn13> run;
+    run.reserve(values.size());
+    for (int value : values) {
+      run.emplace_back(value);
+    }
+    return run;
+  };
+  std::vector<ThrowsOn13> run = make_run({0, 5, 13, 20});
+  std::vector<bool> inserted;
+  EXPECT_THROW(
+      s.insert_sorted(run.begin(), run.end(), std::back_inserter(inserted)),
+      std::runtime_error);
+  EXPECT_TRUE(inserted.empty());
+  EXPECT_EQ(s.size(), 2U);
+  for (int i = 3; i < 200; i++) {
+    s.insert(ThrowsOn13(i * 2));
+  }
+  run = make_run({500, 1013, 1500});
+  EXPECT_THROW(
+      s.insert_sorted(run.begin(), run.end(), std::back_inserter(inserted)),
+      std::runtime_error);
+  EXPECT_EQ(inserted, std::vector<bool>{true});
+  EXPECT_EQ(s.size(), 200U);
+  EXPECT_TRUE(s.contains(ThrowsOn13(500)));
+  EXPECT_FALSE(s.contains(ThrowsOn13(1500)));
+}
+
+// Rotations move the root on most updates; iterators taken before them
+// must still meet a fresh end() and step back from an old one.
+TEST(SetTests, EraseWhileIterating) {
+  s21::S21Set<int> s;
+  for (int i = 0; i < 25; i++) {
+    s.insert(i);
+  }
+  auto old_end = s.end();
+  for (auto it = s.begin(); it != s.end();) {
+    auto next = it;
+    ++next;
+    if (*it % 2 == 0) {
+      s.erase(it);
+    }
+    it = next;
+  }
+  EXPECT_EQ(s.size(), 12U);
+  EXPECT_TRUE(old_end == s.end());
+  EXPECT_FALSE(old_end != s.end());
+  EXPECT_EQ(*--old_end, 23);
+  for (auto it = s.begin(); it != s.end();) {
+    auto next = it;
+    ++next;
+    s.erase(it);
+    it = next;
+  }
+  EXPECT_TRUE(s.empty());
+}
+
+// Jumps and distances count positions from the tree as it is now, not as
+// it was when the iterator was made.
+TEST(SetTests, IteratorArithmeticSurvivesUpdates) {
+  s21::S21Set<int> s;
+  for (int i = 0; i < 10; i++) {
+    s.insert(i);
+  }
+  auto five = s.find(5);
+  auto first = s.begin();
+  s.insert(-100);
+  EXPECT_EQ(*(five + 1), 6);
+  EXPECT_EQ(*(five - 1), 4);
+  for (int i = -9; i < 0; i++) {
+    s.insert(i);
+  }
+  EXPECT_EQ(*first, 0);
+  EXPECT_EQ(first - s.find(0), 0);
+  EXPECT_EQ(five - s.begin(), 15);
+  s.erase(s.find(-100));
+  EXPECT_EQ(s.end() - five, 5);
+  first += 3;
+  EXPECT_EQ(*first, 3);
+}
+
+struct CopyCounted {
+  static int copies;
+  int value;
+  explicit CopyCounted(int v) : value(v) {}
+  CopyCounted(const CopyCounted &other) : value(other.value) { copies++; }
+  CopyCounted &operator=(const CopyCounted &) = default;
+  bool operator<(const CopyCounted &other) const {
+    return value < other.value;
+  }
+};
+
+int CopyCounted::copies = 0;
+
+// A hinted duplicate is found before any node is built for it.
+TEST(SetTests, HintedDuplicateIsNeverCopied) {
+  s21::S21Set<CopyCounted> s;
+  for (int i = 0; i < 10; i++) {
+    s.emplace(i);
+  }
+  auto arena_capacity = s.arena()->capacity();
+  CopyCounted five(5);
+  CopyCounted::copies = 0;
+  auto it = s.insert(s.find(five), five);
+  auto again = s.insert(s.find(CopyCounted(6)), five);
+  auto unhinted = s.insert(s.begin(), five);
+  EXPECT_EQ(CopyCounted::copies, 0);
+  EXPECT_EQ((*it).value, 5);
+  EXPECT_TRUE(it == again && it == unhinted);
+  EXPECT_EQ(s.size(), 10U);
+  EXPECT_EQ(s.arena()->capacity(), arena_capacity);
+  s.insert(s.end(), CopyCounted(20));
+  EXPECT_EQ(CopyCounted::copies, 1);
+}